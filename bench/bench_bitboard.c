@@ -0,0 +1,126 @@
+#define _DEFAULT_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include <errno.h>
+
+#include "game_utils.h"   // die, DX/DY, in_bounds_wh, idx_wh
+#include "shared_mem.h"   // gs_alloc_local, gs_cells_t
+#include "bitboard.h"     // bb_mobility_rows, bb_mobility_at, bb_patch7
+#include "bench_common.h" // now_ns
+
+/*
+ * Micro-benchmark de los kernels de bitboard contra el código escalar que
+ * reemplazan (8 vecinos con chequeo de bordes sobre el board int):
+ *   map   : vecinos libres de todo el tablero (gs_rebuild_counters)
+ *   point : vecinos libres de una celda (movilidad de rivales)
+ *   cands : movilidad de las 8 candidatas de un jugador (núcleo de las estrategias)
+ * Cada par tiene que dar el mismo checksum.
+ */
+
+#define USAGE "Uso: bench_bitboard [-w W] [-h H] [-n queries] [-r maps]"
+#define NPOS 4096
+
+static volatile unsigned long long g_sink; // evita que se optimicen los loops
+
+static inline int scalar_mobility(const game_state_t *gs, int x, int y){
+    int m = 0;
+    for (int d = 0; d < 8; ++d) {
+        int nx = x + DX[d], ny = y + DY[d];
+        if (in_bounds_wh(nx, ny, gs->width, gs->height) && gs->board[idx_wh(nx, ny, gs->width)] > 0) m++;
+    }
+    return m;
+}
+
+static void scalar_map(const game_state_t *gs, unsigned char *out){
+    for (int y = 0; y < gs->height; ++y)
+        for (int x = 0; x < gs->width; ++x) out[idx_wh(x, y, gs->width)] = (unsigned char)scalar_mobility(gs, x, y);
+}
+
+static unsigned long long sum_bytes(const unsigned char *p, size_t n){
+    unsigned long long s = 0;
+    for (size_t i = 0; i < n; ++i) s += p[i] * (i % 7 + 1);
+    return s;
+}
+
+int main(int argc, char **argv){
+    int W = 100, H = 100;
+    long queries = 2000000, maps = 500;
+    int opt;
+    while ((opt = getopt(argc, argv, "w:h:n:r:")) != -1) {
+        switch (opt) {
+        case 'w': W = atoi(optarg); break;
+        case 'h': H = atoi(optarg); break;
+        case 'n': queries = atol(optarg); break;
+        case 'r': maps = atol(optarg); break;
+        default: die(USAGE);
+        }
+    }
+    if (W < 10 || H < 10 || queries < 1 || maps < 1) die(USAGE);
+
+    // mitad de partida: ~40% capturado al azar
+    game_state_t *gs = NULL; size_t bytes = 0;
+    if (gs_alloc_local(W, H, 1, 0, &gs, &bytes) != 0) die("gs_alloc_local(%dx%d)", W, H);
+    unsigned rng = 4242u;
+    gs_init_board_rewards_r(gs->board, W, H, &rng);
+    for (size_t i = 0, tot = (size_t)W * H; i < tot; ++i)
+        if (rand_r(&rng) % 10 < 4) gs->board[i] = 0;
+    gs_rebuild_counters(gs);
+    gs_cells_t c; gs_cells_bind(&c, gs);
+
+    static unsigned short pos[NPOS][2];
+    for (int k = 0; k < NPOS; ++k) { pos[k][0] = (unsigned short)(rand_r(&rng) % W); pos[k][1] = (unsigned short)(rand_r(&rng) % H); }
+
+    size_t cells = (size_t)W * H;
+    unsigned char *ma = malloc(cells), *mb = malloc(cells);
+    if (!ma || !mb) die("malloc: %s", strerror(errno));
+    printf("board %dx%d  free=%u\n", W, H, gs_count_free_cells(gs));
+
+    // map
+    double t0 = now_ns();
+    for (long k = 0; k < maps; ++k) { __asm__ volatile("" ::: "memory"); scalar_map(gs, ma); }
+    double ts = (now_ns() - t0) / (double)maps;
+    t0 = now_ns();
+    for (long k = 0; k < maps; ++k) { __asm__ volatile("" ::: "memory"); bb_mobility_rows(&c, 0, H, mb); }
+    double tb = (now_ns() - t0) / (double)maps;
+    printf("map    scalar=%10.0f ns  bitboard=%10.0f ns  x%.1f  checksum %llu/%llu\n",
+           ts, tb, ts / tb, sum_bytes(ma, cells), sum_bytes(mb, cells));
+
+    // point
+    unsigned long long sa = 0, sb = 0;
+    t0 = now_ns();
+    for (long k = 0; k < queries; ++k) sa += (unsigned)scalar_mobility(gs, pos[k % NPOS][0], pos[k % NPOS][1]);
+    ts = (now_ns() - t0) / (double)queries;
+    t0 = now_ns();
+    for (long k = 0; k < queries; ++k) sb += (unsigned)bb_mobility_at(&c, pos[k % NPOS][0], pos[k % NPOS][1]);
+    tb = (now_ns() - t0) / (double)queries;
+    printf("point  scalar=%10.1f ns  bitboard=%10.1f ns  x%.1f  checksum %llu/%llu\n", ts, tb, ts / tb, sa, sb);
+
+    // cands: movilidad de cada una de las 8 candidatas libres
+    sa = sb = 0;
+    t0 = now_ns();
+    for (long k = 0; k < queries; ++k) {
+        int x = pos[k % NPOS][0], y = pos[k % NPOS][1];
+        for (int d = 0; d < 8; ++d) {
+            int nx = x + DX[d], ny = y + DY[d];
+            if (in_bounds_wh(nx, ny, W, H) && gs->board[idx_wh(nx, ny, W)] > 0)
+                sa += (unsigned)(scalar_mobility(gs, nx, ny) * (d + 1));
+        }
+    }
+    ts = (now_ns() - t0) / (double)queries;
+    t0 = now_ns();
+    for (long k = 0; k < queries; ++k) {
+        uint64_t p = bb_patch7(&c, pos[k % NPOS][0], pos[k % NPOS][1]);
+        for (int d = 0; d < 8; ++d)
+            if (p & BB_P(DX[d], DY[d])) sb += (unsigned)(bb_count(p, BB_RING1, DX[d], DY[d]) * (d + 1));
+    }
+    tb = (now_ns() - t0) / (double)queries;
+    printf("cands  scalar=%10.1f ns  bitboard=%10.1f ns  x%.1f  checksum %llu/%llu\n", ts, tb, ts / tb, sa, sb);
+
+    g_sink = sa + sb;
+    free(ma); free(mb);
+    gs_free_local(gs);
+    return 0;
+}
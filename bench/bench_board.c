@@ -0,0 +1,118 @@
+#define _DEFAULT_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include <errno.h>
+
+#include "game_utils.h"         // die
+#include "shared_mem.h"         // gs_cells_t, gs_free_local, GS_F_COMPACT
+#include "player_strategies.h"  // pick_move_strategy, strategy_name
+#include "bitboard.h"           // bb_count_free_rows
+#include "bench_common.h"       // now_ns, bench_make_state
+
+/*
+ * Benchmark del encoding del tablero: board int (layout de la cátedra) vs espejo
+ * compacto (1 byte/celda), más el bitmap de libres que tienen ambos. Sobre el
+ * mismo estado de mitad de partida mide escaneos completos del tablero y
+ * decisiones de cada estrategia.
+ * El checksum de direcciones tiene que coincidir entre layouts.
+ */
+
+#define USAGE "Uso: bench_board [-w W] [-h H] [-n decisions] [-r scans]"
+
+static volatile unsigned long long g_sink; // evita que se optimicen los loops
+
+#define NPOS 4096
+
+// Estado de mitad de partida: ~40% de las celdas capturadas al azar por los 9 jugadores
+#define BOARD_SEED     4242u
+#define BOARD_CAPTURED 40u
+
+// Posiciones de decisión: celdas capturadas con al menos un vecino libre (igual para ambos layouts)
+static void pick_positions(const game_state_t *gs, unsigned short pos[NPOS][2]){
+    unsigned rng = 77u;
+    int W = gs->width, H = gs->height;
+    for (int k = 0; k < NPOS; ) {
+        int x = rand_r(&rng) % W, y = rand_r(&rng) % H;
+        if (gs->board[y * W + x] <= 0 && gs_has_valid_move_from(gs, x, y)) {
+            pos[k][0] = (unsigned short)x; pos[k][1] = (unsigned short)y; k++;
+        }
+    }
+}
+
+// Escaneo completo: cantidad de libres recorriendo el encoding que corresponda
+static unsigned scan_free(const gs_cells_t *c){
+    unsigned n = 0;
+    size_t tot = (size_t)c->W * c->H;
+    if (c->cells) {
+        for (size_t i = 0; i < tot; ++i) n += GS_CELL_FREE(c->cells[i]);
+        return n;
+    }
+    for (size_t i = 0; i < tot; ++i) n += c->board[i] > 0;
+    return n;
+}
+
+static double time_scan(unsigned (*fn)(const gs_cells_t *), const gs_cells_t *c, long scans){
+    double t0 = now_ns();
+    unsigned long long sink = 0;
+    for (long k = 0; k < scans; ++k) {
+        __asm__ volatile("" ::: "memory"); // el board "puede cambiar": no sacar el escaneo del loop
+        sink += fn(c);
+    }
+    g_sink = sink;
+    return (now_ns() - t0) / (double)scans;
+}
+
+static unsigned scan_bits(const gs_cells_t *c){
+    return bb_count_free_rows(c, 0, c->H);
+}
+
+static void run_layout(const char *label, game_state_t *gs, long decisions, long scans){
+    gs_cells_t c; gs_cells_bind(&c, gs);
+    static unsigned short pos[NPOS][2];
+    pick_positions(gs, pos);
+
+    printf("%-8s scan=%10.0f ns  bitmap scan=%8.0f ns (free=%u)\n", label,
+           time_scan(scan_free, &c, scans), time_scan(scan_bits, &c, scans), scan_free(&c));
+    for (int s = 0; s < STRAT_COUNT; ++s) {
+        if (s == STRAT_RANDOM_TIEBREAK) continue; // usa rand(): no es comparable entre layouts
+        if (s == STRAT_SEARCH) continue;          // gasta su presupuesto de tiempo: ver tournament
+        if (s == STRAT_TERRITORY) continue;       // 8 BFS por decisión: ver bench_territory
+        unsigned long long sum = 0;
+        double a = now_ns();
+        for (long k = 0; k < decisions; ++k) {
+            player_t *p = &gs->players[k % 9];
+            p->x = pos[k % NPOS][0]; p->y = pos[k % NPOS][1];
+            sum += pick_move_strategy((strategy_t)s, gs, (int)(k % 9));
+        }
+        double per = (now_ns() - a) / (double)decisions;
+        printf("         %-9s %8.1f ns/decision  checksum=%llu\n", strategy_name((strategy_t)s), per, sum);
+    }
+}
+
+int main(int argc, char **argv){
+    int W = 100, H = 100;
+    long decisions = 1000000, scans = 2000;
+    int opt;
+    while ((opt = getopt(argc, argv, "w:h:n:r:")) != -1) {
+        switch (opt) {
+        case 'w': W = atoi(optarg); break;
+        case 'h': H = atoi(optarg); break;
+        case 'n': decisions = atol(optarg); break;
+        case 'r': scans = atol(optarg); break;
+        default: die(USAGE);
+        }
+    }
+    if (W < 10 || H < 10 || decisions < 1 || scans < 1) die(USAGE);
+
+    game_state_t *gi = bench_make_state(W, H, 9, BOARD_CAPTURED, BOARD_SEED, 0);
+    game_state_t *gc = bench_make_state(W, H, 9, BOARD_CAPTURED, BOARD_SEED, GS_F_COMPACT);
+    printf("board %dx%d  int=%zu B  compact=+%zu B (cells)\n", W, H,
+           (size_t)W * H * sizeof(int), gs_bytes_for(W, H, GS_F_COMPACT) - gs_bytes_for(W, H, 0));
+    run_layout("int", gi, decisions, scans);
+    run_layout("compact", gc, decisions, scans);
+    gs_free_local(gi); gs_free_local(gc);
+    return 0;
+}
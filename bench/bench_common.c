@@ -0,0 +1,15 @@
+#define _DEFAULT_SOURCE
+#include <stdlib.h>
+#include "bench_common.h"
+#include "game_utils.h"   // die
+
+game_state_t *bench_make_state(int W, int H, unsigned np, unsigned captured_pct, unsigned seed, unsigned flags){
+    game_state_t *gs = NULL; size_t bytes = 0;
+    if (gs_alloc_local(W, H, np, flags, &gs, &bytes) != 0) die("gs_alloc_local(%dx%d)", W, H);
+    unsigned rng = seed;
+    gs_init_board_rewards_r(gs->board, W, H, &rng);
+    for (size_t i = 0, tot = (size_t)W * H; i < tot; ++i)
+        if ((unsigned)rand_r(&rng) % 100u < captured_pct) gs->board[i] = -(int)(rand_r(&rng) % np);
+    if (gs_place_players_r(gs, &rng) != 0) die("gs_place_players_r"); // reconstruye contadores/espejo
+    return gs;
+}
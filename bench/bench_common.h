@@ -0,0 +1,30 @@
+#ifndef BENCH_COMMON_H
+#define BENCH_COMMON_H
+
+#pragma once
+#include <time.h>
+#include "shared_mem.h"   // game_state_t
+
+/* ===== Utilidades comunes de los benchmarks =====
+   Reloj, comparador para percentiles y el corpus de estados de mitad de partida: todos los
+   benchmarks arman sus tableros con bench_make_state para que los corpus no se separen. */
+
+/* CLOCK_MONOTONIC en ns. */
+static inline double now_ns(void){
+    struct timespec ts; clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+/* Orden ascendente de double para qsort (latencias -> percentiles). */
+static inline int cmp_double(const void *a, const void *b){
+    double x = *(const double *)a, y = *(const double *)b;
+    return (x > y) - (x < y);
+}
+
+/* Estado de mitad de partida W×H con np jugadores (flags de gs_alloc_local): recompensas,
+   ~captured_pct% de las celdas capturadas por jugadores al azar y los jugadores ubicados en
+   libres, todo de un único rand_r(seed) (misma semilla, mismo estado). Muere si no hay
+   memoria o lugar para los jugadores; se libera con gs_free_local. */
+game_state_t *bench_make_state(int W, int H, unsigned np, unsigned captured_pct, unsigned seed, unsigned flags);
+
+#endif
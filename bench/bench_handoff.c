@@ -0,0 +1,95 @@
+#define _DEFAULT_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include <errno.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+
+#include "game_utils.h"   // die, proto_read_dir/proto_write_dir
+#include "sync_utils.h"   // game_sync_t, gx_init, sync_allow_one_move/sync_wait_my_turn, mbox_*
+#include "bench_common.h" // now_ns
+
+/*
+ * Benchmark del traspaso de turno máster ↔ jugador, con las APIs reales:
+ *   pipe : sem_post(movement[i]) → sem_wait → write 1 byte → read
+ *   futex: grant en mbox[i] → wait → mbox_reply → timbre → mbox_take
+ * Cada ida y vuelta equivale a un movimiento sin costo de estrategia. Al final el jugador
+ * futex se retira con mbox_close y se verifica que el cierre se informe una sola vez.
+ */
+
+#define USAGE "Uso: bench_handoff [-n moves]"
+
+// Jugador: espera turno y responde siempre la misma dirección
+static void player_loop(game_sync_t *gx, int wfd, long moves){
+    for (long k = 0; k < moves; ++k) {
+        if (sync_wait_my_turn(gx, 0) == -1) _exit(1);
+        if (gx->transport == XPORT_FUTEX) mbox_reply(gx, 0, DIR_E);
+        else if (proto_write_dir(wfd, DIR_E) != 0) _exit(1);
+    }
+    if (gx->transport == XPORT_FUTEX) mbox_close(gx, 0);   // se retira como un jugador bloqueado
+    _exit(0);
+}
+
+static void run_transport(unsigned transport, long moves){
+    game_sync_t *gx = mmap(NULL, sizeof(game_sync_t), PROT_READ|PROT_WRITE, MAP_SHARED|MAP_ANONYMOUS, -1, 0);
+    if (gx == MAP_FAILED) die("mmap: %s", strerror(errno));
+    if (gx_init(gx) != 0) die("gx_init: %s", strerror(errno));
+    gx->transport = transport;
+
+    int fds[2];
+    if (pipe(fds) == -1) die("pipe: %s", strerror(errno));
+    pid_t pid = fork();
+    if (pid < 0) die("fork: %s", strerror(errno));
+    if (pid == 0) { close(fds[0]); player_loop(gx, fds[1], moves); }
+    close(fds[1]);
+
+    double t0 = now_ns();
+    for (long k = 0; k < moves; ++k) {
+        unsigned char dir = 0;
+        sync_allow_one_move(gx, 0);
+        if (transport == XPORT_FUTEX) {
+            for (;;) {
+                unsigned seen = mbox_doorbell(gx);
+                if (mbox_take(gx, 0, &dir) == 0) break;
+                mbox_wait_doorbell(gx, seen, 1000);
+            }
+        } else if (proto_read_dir(fds[0], &dir) != 0) {
+            die("proto_read_dir");
+        }
+    }
+    double ns = now_ns() - t0;
+    waitpid(pid, NULL, 0);
+    if (transport == XPORT_FUTEX) {
+        // el cierre tiene que verse una vez y después el buzón queda sin pendientes
+        unsigned char dir = 0;
+        if (mbox_take(gx, 0, &dir) != 1) die("futex: mbox_close no llegó");
+        if (mbox_pending(gx, 1) != 0 || mbox_take(gx, 0, &dir) != 2) die("futex: buzón cerrado informado más de una vez");
+    }
+    close(fds[0]);
+
+    printf("%-5s moves=%ld  moves/s=%12.0f  handoff=%8.0f ns\n",
+           transport == XPORT_FUTEX ? "futex" : "pipe", moves,
+           (double)moves / (ns / 1e9), ns / (double)moves);
+
+    gx_destroy_sems(gx);
+    munmap(gx, sizeof(game_sync_t));
+}
+
+int main(int argc, char **argv){
+    long moves = 200000;
+    int opt;
+    while ((opt = getopt(argc, argv, "n:")) != -1) {
+        switch (opt) {
+        case 'n': moves = atol(optarg); break;
+        default: die(USAGE);
+        }
+    }
+    if (moves < 1) die(USAGE);
+
+    run_transport(XPORT_PIPE,  moves);
+    run_transport(XPORT_FUTEX, moves);
+    return 0;
+}
@@ -0,0 +1,270 @@
+#define _GNU_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include <errno.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+
+#include "game_utils.h"   // die, proto_read_dir/proto_write_dir
+#include "sync_utils.h"   // game_sync_t, gx_init, sync_allow_one_move/sync_wait_my_turn, mbox_*, sem_wait_intr
+#include "lat_hist.h"     // hist_record, hist_percentile
+#include "bench_common.h" // now_ns
+
+/*
+ * Micro-benchmark de las primitivas de IPC del turno, con las APIs reales. Cada ida y
+ * vuelta es máster → par → máster, atendiendo a los pares en round-robin como el máster:
+ *   pipe    : proto_write_dir → proto_read_dir en un pipe por sentido
+ *   sem     : sync_allow_one_move (movement[i]) → sync_wait_my_turn; respuesta por otro sem_t
+ *   sem+pipe: movement[i] + 1 byte por pipe (transporte XPORT_PIPE del juego)
+ *   futex   : buzón mbox[i] + timbre (transporte XPORT_FUTEX del juego)
+ *   view    : state_changed / state_rendered (sync_notify_view_and_delay); hay una sola vista
+ *   ring    : anillo SPSC en shm por sentido, espera activa (sched_yield tras RING_SPINS vueltas)
+ * Con 1..9 pares, sin afinidad y con cada proceso fijado a un núcleo (el máster al 0, el par i
+ * al 1+i módulo los núcleos: con un solo núcleo todos comparten el 0).
+ */
+
+#define USAGE "Uso: bench_ipc [-n idas_y_vueltas] [-P pares] [-p primitivas] [-c libre|fijado|ambos]"
+
+#define RING_CAP   64u              /* potencia de 2 */
+#define RING_SPINS 128u
+
+enum { P_PIPE, P_SEM, P_SEMPIPE, P_FUTEX, P_VIEW, P_RING, P_COUNT };
+static const char *const PRIM_NAMES[P_COUNT] = {
+    [P_PIPE] = "pipe", [P_SEM] = "sem", [P_SEMPIPE] = "sem+pipe",
+    [P_FUTEX] = "futex", [P_VIEW] = "view", [P_RING] = "ring",
+};
+
+// Anillo de un productor y un consumidor, índices libres de desborde (módulo 2^32)
+typedef struct {
+    _Alignas(64) atomic_uint head;  // consumidor
+    _Alignas(64) atomic_uint tail;  // productor
+    unsigned char buf[RING_CAP];
+} ring_t;
+
+typedef struct {
+    game_sync_t gx;
+    sem_t reply[MAXP];              // P_SEM: par → máster
+    ring_t req[MAXP], rep[MAXP];    // P_RING: máster → par, par → máster
+} shared_t;
+
+typedef struct { int req[2], rep[2]; } pipes_t;
+
+// ===== anillo =====
+// Espera a que *a deje de valer v: primero activa, después cediendo el núcleo
+static void ring_wait(atomic_uint *a, unsigned v){
+    for (unsigned s = 0; atomic_load_explicit(a, memory_order_acquire) == v; ++s)
+        if (s >= RING_SPINS) sched_yield();
+}
+
+static void ring_push(ring_t *r, unsigned char v){
+    unsigned t = atomic_load_explicit(&r->tail, memory_order_relaxed);
+    for (;;) {
+        unsigned h = atomic_load_explicit(&r->head, memory_order_acquire);
+        if (t - h < RING_CAP) break;
+        ring_wait(&r->head, h);     // lleno
+    }
+    r->buf[t & (RING_CAP - 1u)] = v;
+    atomic_store_explicit(&r->tail, t + 1u, memory_order_release);
+}
+
+static unsigned char ring_pop(ring_t *r){
+    unsigned h = atomic_load_explicit(&r->head, memory_order_relaxed);
+    ring_wait(&r->tail, h);         // vacío
+    unsigned char v = r->buf[h & (RING_CAP - 1u)];
+    atomic_store_explicit(&r->head, h + 1u, memory_order_release);
+    return v;
+}
+
+// ===== afinidad =====
+static cpu_set_t g_all_cpus;        // máscara original del proceso
+
+static void pin_to(int cpu){
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    if (sched_setaffinity(0, sizeof set, &set) != 0) die("sched_setaffinity(%d): %s", cpu, strerror(errno));
+}
+
+// Núcleo del proceso k (0 = máster, 1+i = par i) entre los ncpu permitidos
+static int cpu_of(int k, int ncpu){
+    int want = k % ncpu;
+    for (int c = 0, seen = 0; c < CPU_SETSIZE; ++c)
+        if (CPU_ISSET(c, &g_all_cpus) && seen++ == want) return c;
+    return 0;
+}
+
+// ===== par =====
+static void peer_loop(int prim, shared_t *sh, const pipes_t *pp, int i, long count){
+    game_sync_t *gx = &sh->gx;
+    for (long k = 0; k < count; ++k) {
+        unsigned char d = DIR_E;
+        switch (prim) {
+        case P_PIPE:
+            if (proto_read_dir(pp->req[0], &d) != 0 || proto_write_dir(pp->rep[1], d) != 0) _exit(1);
+            break;
+        case P_SEM:
+            if (sync_wait_my_turn(gx, i) == -1) _exit(1);
+            sem_post(&sh->reply[i]);
+            break;
+        case P_SEMPIPE:
+            if (sync_wait_my_turn(gx, i) == -1 || proto_write_dir(pp->rep[1], d) != 0) _exit(1);
+            break;
+        case P_FUTEX:
+            if (sync_wait_my_turn(gx, i) == -1) _exit(1);
+            mbox_reply(gx, i, d);
+            break;
+        case P_VIEW:
+            if (sem_wait_intr(&gx->state_changed) != 0) _exit(1);
+            sem_post(&gx->state_rendered);
+            break;
+        case P_RING:
+            ring_push(&sh->rep[i], ring_pop(&sh->req[i]));
+            break;
+        }
+    }
+    _exit(0);
+}
+
+// ===== máster: una ida y vuelta con el par i =====
+static void round_trip(int prim, shared_t *sh, const pipes_t *pp, int i){
+    game_sync_t *gx = &sh->gx;
+    unsigned char d = DIR_E;
+    switch (prim) {
+    case P_PIPE:
+        if (proto_write_dir(pp->req[1], d) != 0 || proto_read_dir(pp->rep[0], &d) != 0) die("pipe %d", i);
+        break;
+    case P_SEM:
+        sync_allow_one_move(gx, i);
+        if (sem_wait_intr(&sh->reply[i]) != 0) die("sem_wait reply[%d]", i);
+        break;
+    case P_SEMPIPE:
+        sync_allow_one_move(gx, i);
+        if (proto_read_dir(pp->rep[0], &d) != 0) die("proto_read_dir %d", i);
+        break;
+    case P_FUTEX:
+        sync_allow_one_move(gx, i);
+        for (;;) {
+            unsigned seen = mbox_doorbell(gx);
+            if (mbox_take(gx, i, &d) == 0) break;
+            mbox_wait_doorbell(gx, seen, 1000);
+        }
+        break;
+    case P_VIEW:
+        sync_notify_view_and_delay(gx, true, NULL, NULL);
+        break;
+    case P_RING:
+        ring_push(&sh->req[i], d);
+        (void)ring_pop(&sh->rep[i]);
+        break;
+    }
+}
+
+static void run(int prim, int npeers, bool pinned, long trips){
+    int ncpu = CPU_COUNT(&g_all_cpus);
+    shared_t *sh = mmap(NULL, sizeof *sh, PROT_READ|PROT_WRITE, MAP_SHARED|MAP_ANONYMOUS, -1, 0);
+    if (sh == MAP_FAILED) die("mmap: %s", strerror(errno));
+    if (gx_init(&sh->gx) != 0) die("gx_init: %s", strerror(errno));
+    sh->gx.transport = prim == P_FUTEX ? XPORT_FUTEX : XPORT_PIPE;
+    for (int i = 0; i < npeers; ++i)
+        if (sem_init(&sh->reply[i], 1, 0) != 0) die("sem_init: %s", strerror(errno));
+
+    pipes_t pp[MAXP];
+    pid_t pid[MAXP];
+    for (int i = 0; i < npeers; ++i)
+        if (pipe(pp[i].req) == -1 || pipe(pp[i].rep) == -1) die("pipe: %s", strerror(errno));
+    if (pinned) pin_to(cpu_of(0, ncpu));
+    for (int i = 0; i < npeers; ++i) {
+        long count = trips / npeers + (i < trips % npeers);
+        pid[i] = fork();
+        if (pid[i] < 0) die("fork: %s", strerror(errno));
+        if (pid[i] == 0) {
+            if (pinned) pin_to(cpu_of(1 + i, ncpu));
+            peer_loop(prim, sh, &pp[i], i, count);
+        }
+    }
+
+    static lat_hist_t h;
+    memset(&h, 0, sizeof h);
+    double t0 = now_ns();
+    for (long k = 0; k < trips; ++k) {
+        int i = (int)(k % npeers);
+        double a = now_ns();
+        round_trip(prim, sh, &pp[i], i);
+        hist_record(&h, (uint64_t)(now_ns() - a));
+    }
+    double el = now_ns() - t0;
+    for (int i = 0; i < npeers; ++i) {
+        int st = 0;
+        if (waitpid(pid[i], &st, 0) == -1 || !WIFEXITED(st) || WEXITSTATUS(st) != 0) die("par %d terminó mal", i);
+        close(pp[i].req[0]); close(pp[i].req[1]);
+        close(pp[i].rep[0]); close(pp[i].rep[1]);
+        sem_destroy(&sh->reply[i]);
+    }
+    if (pinned && sched_setaffinity(0, sizeof g_all_cpus, &g_all_cpus) != 0) die("sched_setaffinity: %s", strerror(errno));
+
+    printf("%-9s %-7s %5d %12.0f %10.0f %10llu %10llu %10llu\n",
+           PRIM_NAMES[prim], pinned ? "fijado" : "libre", npeers, (double)trips / (el / 1e9), hist_mean(&h),
+           (unsigned long long)hist_percentile(&h, 0.50), (unsigned long long)hist_percentile(&h, 0.99),
+           (unsigned long long)h.max_ns);
+    fflush(stdout);
+    gx_destroy_sems(&sh->gx);
+    munmap(sh, sizeof *sh);
+}
+
+int main(int argc, char **argv){
+    long trips = 20000;
+    int peers[MAXP] = { 1, 2, 4, 9 }, npeers = 4;
+    bool prims[P_COUNT];
+    for (int p = 0; p < P_COUNT; ++p) prims[p] = true;
+    bool run_free = true, run_pinned = true;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "n:P:p:c:")) != -1) {
+        switch (opt) {
+        case 'n': trips = atol(optarg); break;
+        case 'P':
+            npeers = 0;
+            for (char *tok = strtok(optarg, ","); tok; tok = strtok(NULL, ",")) {
+                int v = atoi(tok);
+                if (npeers == MAXP || v < 1 || v > MAXP) die("pares: 1..%d\n" USAGE, MAXP);
+                peers[npeers++] = v;
+            }
+            break;
+        case 'p':
+            memset(prims, 0, sizeof prims);
+            for (char *tok = strtok(optarg, ","); tok; tok = strtok(NULL, ",")) {
+                int p = 0;
+                while (p < P_COUNT && strcmp(tok, PRIM_NAMES[p]) != 0) ++p;
+                if (p == P_COUNT) die("primitiva desconocida: %s", tok);
+                prims[p] = true;
+            }
+            break;
+        case 'c':
+            run_free = strcmp(optarg, "fijado") != 0;
+            run_pinned = strcmp(optarg, "libre") != 0;
+            if (!run_free && !run_pinned) die(USAGE);
+            break;
+        default: die(USAGE);
+        }
+    }
+    if (trips < 1 || npeers < 1) die(USAGE);
+    if (sched_getaffinity(0, sizeof g_all_cpus, &g_all_cpus) != 0) die("sched_getaffinity: %s", strerror(errno));
+
+    printf("%ld idas y vueltas por corrida, %d núcleos disponibles (latencias en ns)\n",
+           trips, CPU_COUNT(&g_all_cpus));
+    printf("%-9s %-7s %5s %12s %10s %10s %10s %10s\n", "primitiva", "cpu", "pares", "idas/s", "media", "p50", "p99", "máx");
+    for (int p = 0; p < P_COUNT; ++p) {
+        if (!prims[p]) continue;
+        for (int k = 0; k < npeers; ++k) {
+            if (p == P_VIEW && peers[k] > 1) continue;   // state_changed/state_rendered: una sola vista
+            if (run_free)   run(p, peers[k], false, trips);
+            if (run_pinned) run(p, peers[k], true, trips);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,88 @@
+#define _DEFAULT_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include <errno.h>
+#include <sys/mman.h>
+
+#include "game_utils.h"         // die
+#include "shared_mem.h"         // gs_bytes_for, gs_init_state, gs_apply_move, GS_MAX_*
+#include "player_strategies.h"  // pick_move_strategy
+#include "bench_common.h"       // now_ns
+
+/*
+ * Benchmark de escala del tablero: para cada lado N arma un estado N×N en
+ * memoria anónima compartida (con o sin MADV_HUGEPAGE), siembra recompensas,
+ * ubica jugadores y aplica hasta M movimientos con greedy. Mide el costo del
+ * setup y los movimientos por segundo para ver dónde empieza a pesar el tamaño.
+ */
+
+#define USAGE "Uso: bench_scale [-n players] [-m moves] [-H] [side1 side2 ...]"
+
+static void run_side(int side, unsigned n, long max_moves, int huge){
+    size_t bytes = gs_bytes_for(side, side, 0);
+    if (huge) bytes = (bytes + GS_HUGEPAGE - 1) & ~(size_t)(GS_HUGEPAGE - 1);
+
+    double t0 = now_ns();
+    game_state_t *gs = mmap(NULL, bytes, PROT_READ|PROT_WRITE, MAP_SHARED|MAP_ANONYMOUS, -1, 0);
+    if (gs == MAP_FAILED) die("mmap(%zu): %s", bytes, strerror(errno));
+    if (huge) (void)madvise(gs, bytes, MADV_HUGEPAGE);
+    gs_init_state(gs, bytes, side, side, n, 0);
+    unsigned rng = 12345u;
+    gs_init_board_rewards_r(gs->board, side, side, &rng);
+    if (gs_place_players_r(gs, &rng) != 0) die("gs_place_players_r");
+    double setup = now_ns() - t0;
+
+    // RR como el máster, sin procesos: solo reglas + estrategia
+    long moves = 0;
+    double t1 = now_ns();
+    gs_mark_blocked_players(gs);
+    while (moves < max_moves && gs_any_player_can_move(gs)) {
+        for (unsigned i = 0; i < n && moves < max_moves; ++i) {
+            if (gs->players[i].blocked) continue;
+            unsigned char dir = pick_move_strategy(STRAT_GREEDY_PLUS, gs, (int)i);
+            if (dir == 255 || !gs_apply_move(gs, (int)i, dir)) gs->players[i].blocked = true;
+            else moves++;
+        }
+        gs_mark_blocked_players(gs);
+    }
+    double play = now_ns() - t1;
+
+    printf("%5dx%-5d shm=%9.1f MiB  setup=%9.2f ms  moves=%-7ld moves/s=%12.0f  free=%u\n",
+           side, side, (double)bytes / (1 << 20), setup / 1e6, moves,
+           moves ? (double)moves / (play / 1e9) : 0.0, gs_count_free_cells(gs));
+    munmap(gs, bytes);
+}
+
+int main(int argc, char **argv){
+    unsigned n = 9;
+    long moves = 100000;
+    int huge = 0;
+    int opt;
+    while ((opt = getopt(argc, argv, "n:m:H")) != -1) {
+        switch (opt) {
+        case 'n': n = (unsigned)atoi(optarg); break;
+        case 'm': moves = atol(optarg); break;
+        case 'H': huge = 1; break;
+        default: die(USAGE);
+        }
+    }
+    if (n < 1 || n > 9 || moves < 1) die(USAGE);
+
+    static const int def_sides[] = { 100, 316, 1000, 2000, 4000 };
+    printf("players=%u  max_moves=%ld  hugepages=%s\n", n, moves, huge ? "on" : "off");
+    if (optind < argc) {
+        for (int a = optind; a < argc; ++a) {
+            int side = atoi(argv[a]);
+            if (side < 10 || side > GS_MAX_SIDE || (size_t)side * (size_t)side > GS_MAX_CELLS)
+                die("lado fuera de rango: %s", argv[a]);
+            run_side(side, n, moves, huge);
+        }
+    } else {
+        for (size_t k = 0; k < sizeof def_sides / sizeof def_sides[0]; ++k)
+            run_side(def_sides[k], n, moves, huge);
+    }
+    return 0;
+}
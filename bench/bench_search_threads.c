@@ -0,0 +1,99 @@
+#define _DEFAULT_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+
+#include "game_utils.h"   // die
+#include "shared_mem.h"   // gs_free_local
+#include "search.h"       // search_pick, search_pool_*, search_pick_parallel
+#include "bench_common.h" // now_ns, cmp_double, bench_make_state
+
+/*
+ * Benchmark de la búsqueda con la raíz repartida en hilos: sobre un corpus fijo de
+ * estados de mitad de partida mide la latencia por decisión (media, p50, máx) de
+ * search_pick_parallel con 1..T hilos a profundidad fija (sin reloj) y la compara con
+ * search_pick secuencial, que es la referencia del speedup. Las jugadas elegidas tienen que
+ * ser las de search_pick para toda cantidad de hilos (checksum; si no, sale con 1).
+ */
+
+#define USAGE "Uso: bench_search_threads [-w W] [-h H] [-p players] [-D depth] [-n decisions] [-T max_threads]"
+
+// Estado k del corpus: ~35% de las celdas capturadas y jugadores ubicados con semilla propia
+#define CORPUS_CAPTURED 35u
+
+typedef struct { double mean, p50, max; unsigned long sum; } run_t;
+
+// n decisiones sobre el corpus; pool == NULL => search_pick secuencial
+static run_t run(search_pool_t *pool, game_state_t **st, int n, const search_limits_t *lim, double *lat){
+    run_t r = { 0, 0, 0, 0 };
+    for (int k = 0; k < n; ++k) {
+        game_state_t *gs = st[k];
+        int me = k % (int)gs->num_players;
+        double t0 = now_ns();
+        unsigned char d = pool ? search_pick_parallel(pool, gs, me, lim) : search_pick(gs, me, lim);
+        lat[k] = (now_ns() - t0) / 1e3;
+        r.sum = r.sum * 31u + d;
+        r.mean += lat[k];
+    }
+    r.mean /= n;
+    qsort(lat, (size_t)n, sizeof *lat, cmp_double);
+    r.p50 = lat[n / 2];
+    r.max = lat[n - 1];
+    return r;
+}
+
+int main(int argc, char **argv){
+    int W = 30, H = 30, np = 4, depth = 7, n = 40;
+    int maxt = (int)sysconf(_SC_NPROCESSORS_ONLN);
+    if (maxt < 4) maxt = 4;   // con pocos núcleos igual se ve el costo de repartir
+    int opt;
+    while ((opt = getopt(argc, argv, "w:h:p:D:n:T:")) != -1) {
+        switch (opt) {
+        case 'w': W = atoi(optarg); break;
+        case 'h': H = atoi(optarg); break;
+        case 'p': np = atoi(optarg); break;
+        case 'D': depth = atoi(optarg); break;
+        case 'n': n = atoi(optarg); break;
+        case 'T': maxt = atoi(optarg); break;
+        default: die(USAGE);
+        }
+    }
+    if (W < 10 || H < 10 || np < 1 || np > 9 || depth < 1 || depth > SEARCH_MAX_DEPTH || n < 1) die(USAGE);
+    if (maxt < 1) maxt = 1;
+    if (maxt > SEARCH_MAX_THREADS) maxt = SEARCH_MAX_THREADS;
+
+    game_state_t **st = malloc((size_t)n * sizeof *st);
+    double *lat = malloc((size_t)n * sizeof *lat);
+    if (!st || !lat) die("malloc");
+    for (int k = 0; k < n; ++k) st[k] = bench_make_state(W, H, (unsigned)np, CORPUS_CAPTURED, 1000u + (unsigned)k, 0);
+    search_limits_t lim = { 0, depth };   // sin reloj: resultado reproducible
+
+    printf("board %dx%d, %d jugadores, profundidad %d, %d decisiones, %ld núcleos\n",
+           W, H, np, depth, n, sysconf(_SC_NPROCESSORS_ONLN));
+    (void)run(NULL, st, n, &lim, lat);   // vuelta sin medir: corpus y contexto del hilo en caché
+    run_t seq = run(NULL, st, n, &lim, lat);
+
+    printf("%-12s %10.1f us/decisión  p50 %10.1f  máx %10.1f  checksum=%lu\n",
+           "secuencial", seq.mean, seq.p50, seq.max, seq.sum);
+
+    int mismatch = 0;
+    for (int t = 1; t <= maxt; t *= 2) {
+        search_pool_t *pool = search_pool_create(t);
+        if (!pool) die("search_pool_create(%d)", t);
+        run_t r = run(pool, st, n, &lim, lat);
+        bool same = r.sum == seq.sum;
+        mismatch += !same;
+        printf("%2d hilo%-5s %10.1f us/decisión  p50 %10.1f  máx %10.1f  speedup %5.2fx  checksum=%lu%s\n",
+               search_pool_threads(pool), search_pool_threads(pool) == 1 ? "" : "s",
+               r.mean, r.p50, r.max, seq.mean / r.mean, r.sum, same ? "" : "  DIFIERE");
+        search_pool_destroy(pool);
+    }
+
+    for (int k = 0; k < n; ++k) gs_free_local(st[k]);
+    free(st);
+    free(lat);
+    search_release();
+    return mismatch ? 1 : 0;
+}
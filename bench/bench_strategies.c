@@ -0,0 +1,495 @@
+#define _DEFAULT_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include <errno.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+
+#include "game_utils.h"         // die
+#include "shared_mem.h"         // gs_alloc_local, gs_apply_move, gs_mark_blocked_players
+#include "player_strategies.h"  // pick_move_strategy_r, strategy_name, strategy_from_name
+#include "search.h"             // search_release
+#include "bench_common.h"       // now_ns, bench_make_state
+
+/*
+ * Arnés de estrategias: costo y calidad de pick_move_strategy sobre un corpus fijo.
+ *  - Costo: para cada lado y cantidad de jugadores arma n estados de mitad de partida con
+ *    semillas derivadas de -s y mide cada estrategia decidiendo por todos los jugadores:
+ *    ns/decisión y, si perf_event_open está permitido, ciclos y cache misses por decisión.
+ *    El tiempo es el de la mejor de WINDOWS ventanas; el checksum de las jugadas detecta
+ *    cambios de comportamiento.
+ *  - Calidad: partidas 1 contra 1 en proceso (mismas reglas que tournament) entre cada par
+ *    de estrategias, alternando quién empieza.
+ * Con -o escribe todo en CSV; con -b compara contra un CSV anterior y sale con 1 si hay
+ * regresiones (más lento que la tolerancia, otras jugadas o menos victorias).
+ */
+
+#define USAGE "Uso: bench_strategies [-s seed] [-n estados] [-w lados] [-P jugadores] [-p estrategias] " \
+              "[-D plies] [-g partidas] [-q lado] [-o out.csv] [-b base.csv] [-T tol%%]"
+
+#define MAX_LIST   16
+#define MIN_NS     10e6             /* cada ventana repite el corpus hasta juntar 10 ms */
+#define WINDOWS    3                /* se queda con la ventana más rápida (ruido del sistema) */
+#define CAPTURED   35               /* % de celdas capturadas en el corpus */
+
+typedef struct {
+    unsigned seed;
+    int nstates;
+    int sides[MAX_LIST], nsides;
+    int players[MAX_LIST], nplayers;
+    strategy_t strat[STRAT_COUNT];
+    int nstrat;
+    int depth;                      // plies fijos de "search" (sin reloj: reproducible)
+    int games;                      // partidas por par
+    int qside;                      // lado del tablero de las partidas
+    const char *out, *base;
+    double tol;                     // tolerancia de tiempo (%)
+} bopts_t;
+
+// ===== contadores de hardware (perf_event_open, opcional) =====
+// Grupo ciclos + cache misses solo en modo usuario (alcanza con perf_event_paranoid <= 2).
+// En contenedores o VMs sin PMU la apertura falla y se reporta solo el tiempo.
+typedef struct {
+    int fd_cycles, fd_misses;
+    bool on;
+} perf_t;
+
+static int perf_event(uint64_t config, int group){
+    struct perf_event_attr a;
+    memset(&a, 0, sizeof a);
+    a.size = sizeof a;
+    a.type = PERF_TYPE_HARDWARE;
+    a.config = config;
+    a.disabled = group < 0;
+    a.exclude_kernel = 1;
+    a.exclude_hv = 1;
+    a.read_format = PERF_FORMAT_GROUP;
+    return (int)syscall(SYS_perf_event_open, &a, 0, -1, group, 0);
+}
+
+static void perf_open(perf_t *p){
+    p->on = false;
+    p->fd_cycles = perf_event(PERF_COUNT_HW_CPU_CYCLES, -1);
+    if (p->fd_cycles < 0) {
+        fprintf(stderr, "perf_event_open: %s (sin ciclos ni cache misses)\n", strerror(errno));
+        return;
+    }
+    p->fd_misses = perf_event(PERF_COUNT_HW_CACHE_MISSES, p->fd_cycles);
+    if (p->fd_misses < 0) {
+        fprintf(stderr, "perf_event_open(cache misses): %s (sin contadores)\n", strerror(errno));
+        close(p->fd_cycles);
+        return;
+    }
+    p->on = true;
+}
+
+static void perf_start(perf_t *p){
+    if (!p->on) return;
+    ioctl(p->fd_cycles, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    ioctl(p->fd_cycles, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+}
+
+// Ciclos y misses desde perf_start; -1 si no hay contadores
+static void perf_stop(perf_t *p, double *cycles, double *misses){
+    *cycles = *misses = -1;
+    if (!p->on) return;
+    ioctl(p->fd_cycles, PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+    struct { uint64_t nr, v[2]; } r;
+    if (read(p->fd_cycles, &r, sizeof r) == (ssize_t)sizeof r && r.nr == 2) {
+        *cycles = (double)r.v[0];
+        *misses = (double)r.v[1];
+    }
+}
+
+static void perf_close(perf_t *p){
+    if (!p->on) return;
+    close(p->fd_misses);
+    close(p->fd_cycles);
+}
+
+// ===== corpus =====
+// Estado k de la configuración (W, np): el de bench_make_state con los bloqueados ya marcados
+static game_state_t *make_state(int W, unsigned np, unsigned seed){
+    game_state_t *gs = bench_make_state(W, W, np, CAPTURED, seed, 0);
+    gs_mark_blocked_players(gs);
+    return gs;
+}
+
+static unsigned corpus_seed(const bopts_t *o, int side, int np, int k){
+    return o->seed * 2654435761u + (unsigned)side * 40503u + (unsigned)np * 977u + (unsigned)k;
+}
+
+// ===== resultados =====
+typedef struct {
+    char kind[8];                   // "time" / "playoff"
+    char strat[16], opp[16];
+    int side, players;
+    unsigned seed;                  // semilla y plies de search: solo se comparan filas iguales
+    int depth;
+    long decisions;
+    double ns, cycles, misses;      // por decisión (-1 = sin contadores)
+    unsigned long long checksum;
+    long games, wins, draws;
+    double score;                   // puntaje medio
+} row_t;
+
+typedef struct { row_t *v; int n, cap; } rows_t;
+
+static row_t *rows_add(rows_t *r){
+    if (r->n == r->cap) {
+        r->cap = r->cap ? r->cap * 2 : 64;
+        r->v = realloc(r->v, (size_t)r->cap * sizeof *r->v);
+        if (!r->v) die("realloc");
+    }
+    row_t *x = &r->v[r->n++];
+    memset(x, 0, sizeof *x);
+    x->cycles = x->misses = -1;
+    return x;
+}
+
+// ===== costo por decisión =====
+// Una pasada por el corpus: decide por cada jugador no bloqueado de cada estado.
+static long corpus_pass(strategy_t s, game_state_t **st, int nstates, int np, unsigned *rng, unsigned long long *sum){
+    long n = 0;
+    for (int k = 0; k < nstates; ++k) {
+        for (int i = 0; i < np; ++i) {
+            if (st[k]->players[i].blocked) continue;
+            unsigned char d = pick_move_strategy_r(s, st[k], i, rng);
+            if (sum) *sum = *sum * 31u + d;
+            n++;
+        }
+    }
+    return n;
+}
+
+// Checksum en una pasada sin medir (también calienta caches); después WINDOWS ventanas
+// medidas de al menos MIN_NS cada una y se reporta la más rápida.
+static void time_strategy(const bopts_t *o, strategy_t s, game_state_t **st, int side, int np, perf_t *pf, rows_t *rows){
+    row_t *r = rows_add(rows);
+    snprintf(r->kind, sizeof r->kind, "time");
+    snprintf(r->strat, sizeof r->strat, "%s", strategy_name(s));
+    r->side = side;
+    r->players = np;
+    r->seed = o->seed;
+    r->depth = o->depth;
+
+    unsigned rng = o->seed;         // desempates de random: mismo corpus, mismas jugadas
+    if (corpus_pass(s, st, o->nstates, np, &rng, &r->checksum) == 0) return;
+
+    perf_start(pf);
+    for (int w = 0; w < WINDOWS; ++w) {
+        long n = 0;
+        double t0 = now_ns(), el;
+        do {
+            n += corpus_pass(s, st, o->nstates, np, &rng, NULL);
+            el = now_ns() - t0;
+        } while (el < MIN_NS);
+        r->decisions += n;
+        double per = el / (double)n;
+        if (w == 0 || per < r->ns) r->ns = per;
+    }
+    perf_stop(pf, &r->cycles, &r->misses);
+    if (r->cycles >= 0) { r->cycles /= (double)r->decisions; r->misses /= (double)r->decisions; }
+}
+
+static void run_timing(const bopts_t *o, rows_t *rows){
+    perf_t pf;
+    perf_open(&pf);
+    game_state_t **st = malloc((size_t)o->nstates * sizeof *st);
+    if (!st) die("malloc");
+
+    printf("%-10s %6s %3s %9s %12s %10s %10s %20s\n",
+           "estrategia", "lado", "np", "decis.", "ns/decis.", "ciclos", "misses", "checksum");
+    for (int a = 0; a < o->nsides; ++a) {
+        for (int b = 0; b < o->nplayers; ++b) {
+            int side = o->sides[a], np = o->players[b];
+            for (int k = 0; k < o->nstates; ++k)
+                st[k] = make_state(side, (unsigned)np, corpus_seed(o, side, np, k));
+            for (int s = 0; s < o->nstrat; ++s) {
+                time_strategy(o, o->strat[s], st, side, np, &pf, rows);
+                const row_t *r = &rows->v[rows->n - 1];
+                printf("%-10s %6d %3d %9ld %12.1f ", r->strat, side, np, r->decisions, r->ns);
+                if (r->cycles >= 0) printf("%10.0f %10.1f", r->cycles, r->misses);
+                else printf("%10s %10s", "-", "-");
+                printf(" %20llu\n", r->checksum);
+                fflush(stdout);
+            }
+            for (int k = 0; k < o->nstates; ++k) gs_free_local(st[k]);
+        }
+    }
+    free(st);
+    perf_close(&pf);
+}
+
+// ===== calidad: partidas 1 contra 1 =====
+// Mayor puntaje; desempata por menos movimientos válidos y luego menos inválidos (como tournament). -1 si empate.
+static int winner_of(const game_state_t *g){
+    const player_t *a = &g->players[0], *b = &g->players[1];
+    int cmp = (a->score != b->score) ? (a->score > b->score ? 1 : -1)
+            : (a->valid_moves != b->valid_moves) ? (a->valid_moves < b->valid_moves ? 1 : -1)
+            : (a->invalid_moves != b->invalid_moves) ? (a->invalid_moves < b->invalid_moves ? 1 : -1)
+            : 0;
+    return cmp > 0 ? 0 : cmp < 0 ? 1 : -1;
+}
+
+// RR de a un movimiento por turno hasta que nadie avance (mismas reglas que master/tournament)
+static void play_game(game_state_t *g, const strategy_t seat[2], unsigned seed){
+    unsigned rng = seed;
+    memset(g->players, 0, sizeof g->players);
+    g->finished = false;
+    gs_init_board_rewards_r(g->board, g->width, g->height, &rng);
+    if (gs_place_players_r(g, &rng) != 0) die("gs_place_players_r");
+
+    gs_mark_blocked_players(g);
+    while (gs_any_player_can_move(g)) {
+        bool progress = false;
+        for (int i = 0; i < 2; ++i) {
+            if (g->players[i].blocked) continue;
+            unsigned char dir = pick_move_strategy_r(seat[i], g, i, &rng);
+            if (dir == 255) { g->players[i].blocked = true; continue; }
+            if (gs_apply_move(g, i, dir)) progress = true;
+            gs_mark_blocked_players(g);
+        }
+        if (!progress) break;
+    }
+    g->finished = true;
+}
+
+// Resultado de un par desde el lado de `strat` contra `opp`
+static void playoff_row(rows_t *rows, const bopts_t *o, strategy_t strat, strategy_t opp){
+    row_t *r = rows_add(rows);
+    snprintf(r->kind, sizeof r->kind, "playoff");
+    snprintf(r->strat, sizeof r->strat, "%s", strategy_name(strat));
+    snprintf(r->opp, sizeof r->opp, "%s", strategy_name(opp));
+    r->side = o->qside;
+    r->players = 2;
+    r->seed = o->seed;
+    r->depth = o->depth;
+    r->games = o->games;
+}
+
+static void run_playoffs(const bopts_t *o, rows_t *rows){
+    game_state_t *g = NULL; size_t bytes = 0;
+    if (gs_alloc_local(o->qside, o->qside, 2, 0, &g, &bytes) != 0) die("gs_alloc_local(%dx%d)", o->qside, o->qside);
+
+    // win% de a contra b; cada par juega una vez y llena las dos celdas
+    double pct[STRAT_COUNT][STRAT_COUNT];
+    long wins[STRAT_COUNT] = { 0 }, played[STRAT_COUNT] = { 0 };
+    for (int a = 0; a < o->nstrat; ++a) {
+        for (int b = a + 1; b < o->nstrat; ++b) {
+            playoff_row(rows, o, o->strat[a], o->strat[b]);
+            playoff_row(rows, o, o->strat[b], o->strat[a]);
+            row_t *ra = &rows->v[rows->n - 2], *rb = &rows->v[rows->n - 1];   // después de crecer
+            unsigned long long sa = 0, sb = 0;
+            for (int j = 0; j < o->games; ++j) {
+                int sta = j & 1;    // alterna quién juega primero
+                strategy_t seat[2];
+                seat[sta] = o->strat[a];
+                seat[1 - sta] = o->strat[b];
+                play_game(g, seat, corpus_seed(o, o->qside, a * STRAT_COUNT + b, j));
+                int w = winner_of(g);
+                sa += g->players[sta].score;
+                sb += g->players[1 - sta].score;
+                if (w < 0) { ra->draws++; rb->draws++; }
+                else if (w == sta) ra->wins++;
+                else rb->wins++;
+            }
+            ra->score = (double)sa / (double)o->games;
+            rb->score = (double)sb / (double)o->games;
+            pct[a][b] = 100.0 * (double)ra->wins / (double)o->games;
+            pct[b][a] = 100.0 * (double)rb->wins / (double)o->games;
+            wins[a] += ra->wins; played[a] += o->games;
+            wins[b] += rb->wins; played[b] += o->games;
+        }
+    }
+    gs_free_local(g);
+
+    printf("\npartidas 1v1 en %dx%d, %d por par (win%% de la fila contra la columna)\n%-10s",
+           o->qside, o->qside, o->games, "");
+    for (int b = 0; b < o->nstrat; ++b) printf(" %9s", strategy_name(o->strat[b]));
+    printf("\n");
+    for (int a = 0; a < o->nstrat; ++a) {
+        printf("%-10s", strategy_name(o->strat[a]));
+        for (int b = 0; b < o->nstrat; ++b) {
+            if (a == b) printf(" %9s", "-");
+            else printf(" %8.1f%%", pct[a][b]);
+        }
+        printf("   total %5.1f%%\n", 100.0 * (double)wins[a] / (double)played[a]);
+    }
+}
+
+// ===== CSV =====
+#define CSV_HEADER "kind,strategy,opponent,side,players,seed,search_depth,decisions,ns_per_decision," \
+                   "cycles_per_decision,cache_misses_per_decision,checksum,games,wins,draws,avg_score"
+#define CSV_COLS   16
+
+static void write_csv(const char *path, const rows_t *rows){
+    FILE *f = fopen(path, "w");
+    if (!f) die("fopen(%s): %s", path, strerror(errno));
+    fprintf(f, "%s\n", CSV_HEADER);
+    for (int i = 0; i < rows->n; ++i) {
+        const row_t *r = &rows->v[i];
+        fprintf(f, "%s,%s,%s,%d,%d,%u,%d,", r->kind, r->strat, r->opp, r->side, r->players, r->seed, r->depth);
+        if (strcmp(r->kind, "time") != 0) {
+            fprintf(f, ",,,,,%ld,%ld,%ld,%.1f\n", r->games, r->wins, r->draws, r->score);
+            continue;
+        }
+        fprintf(f, "%ld,%.1f,", r->decisions, r->ns);
+        if (r->cycles >= 0) fprintf(f, "%.0f,%.2f,", r->cycles, r->misses);
+        else fprintf(f, ",,");          // sin contadores de hardware
+        fprintf(f, "%llu,,,,\n", r->checksum);
+    }
+    if (fclose(f) != 0) die("fclose(%s): %s", path, strerror(errno));
+    printf("\nCSV: %s (%d filas)\n", path, rows->n);
+}
+
+// Parsea una fila del CSV (campos vacíos = 0); 0 si ok
+static int parse_row(char *line, row_t *r){
+    char *f[CSV_COLS];
+    int n = 0;
+    for (char *p = line; n < CSV_COLS; ++n) {
+        f[n] = strsep(&p, ",\n");
+        if (!f[n]) break;
+    }
+    if (n < CSV_COLS) return -1;
+    memset(r, 0, sizeof *r);
+    snprintf(r->kind, sizeof r->kind, "%s", f[0]);
+    snprintf(r->strat, sizeof r->strat, "%s", f[1]);
+    snprintf(r->opp, sizeof r->opp, "%s", f[2]);
+    r->side = atoi(f[3]);
+    r->players = atoi(f[4]);
+    r->seed = (unsigned)strtoul(f[5], NULL, 10);
+    r->depth = atoi(f[6]);
+    r->decisions = atol(f[7]);
+    r->ns = atof(f[8]);
+    r->checksum = strtoull(f[11], NULL, 10);
+    r->games = atol(f[12]);
+    r->wins = atol(f[13]);
+    return 0;
+}
+
+static const row_t *find_row(const rows_t *rows, const row_t *k){
+    for (int i = 0; i < rows->n; ++i) {
+        const row_t *r = &rows->v[i];
+        if (strcmp(r->kind, k->kind) == 0 && strcmp(r->strat, k->strat) == 0 &&
+            strcmp(r->opp, k->opp) == 0 && r->side == k->side && r->players == k->players &&
+            r->seed == k->seed && r->depth == k->depth)
+            return r;
+    }
+    return NULL;
+}
+
+// Compara contra la línea base: devuelve la cantidad de regresiones
+static int compare_base(const bopts_t *o, const rows_t *rows){
+    FILE *f = fopen(o->base, "r");
+    if (!f) die("fopen(%s): %s", o->base, strerror(errno));
+    char line[512];
+    int regress = 0, matched = 0;
+    printf("\ncomparación con %s (tolerancia de tiempo %.0f%%)\n", o->base, o->tol);
+    if (!fgets(line, sizeof line, f) || strncmp(line, CSV_HEADER, strlen(CSV_HEADER)) != 0)
+        die("%s: no es un CSV de bench_strategies", o->base);
+    while (fgets(line, sizeof line, f)) {
+        row_t b;
+        if (parse_row(line, &b) != 0) continue;
+        const row_t *r = find_row(rows, &b);
+        if (!r) continue;
+        matched++;
+        if (strcmp(b.kind, "time") == 0) {
+            if (r->checksum != b.checksum) {
+                printf("  %-10s %5dx%-5d np=%d: otras jugadas (checksum %llu, antes %llu)\n",
+                       r->strat, r->side, r->side, r->players, r->checksum, b.checksum);
+                regress++;
+            }
+            if (b.ns > 0 && r->ns > b.ns * (1.0 + o->tol / 100.0)) {
+                printf("  %-10s %5dx%-5d np=%d: %.1f ns/decisión, antes %.1f (+%.0f%%)\n",
+                       r->strat, r->side, r->side, r->players, r->ns, b.ns, 100.0 * (r->ns / b.ns - 1.0));
+                regress++;
+            }
+        } else if (b.games > 0 && r->games > 0) {
+            double now = 100.0 * (double)r->wins / (double)r->games;
+            double before = 100.0 * (double)b.wins / (double)b.games;
+            if (now < before - 10.0) {
+                printf("  %-10s vs %-10s: win%% %.1f, antes %.1f\n", r->strat, r->opp, now, before);
+                regress++;
+            }
+        }
+    }
+    fclose(f);
+    printf("  %d filas comparadas, %d regresiones\n", matched, regress);
+    return regress;
+}
+
+// ===== argv =====
+static int parse_ints(char *arg, int *out, int lo, int hi){
+    int n = 0;
+    for (char *tok = strtok(arg, ","); tok; tok = strtok(NULL, ",")) {
+        int v = atoi(tok);
+        if (n == MAX_LIST || v < lo || v > hi) die("valor inválido: %s\n" USAGE, tok);
+        out[n++] = v;
+    }
+    if (n == 0) die(USAGE);
+    return n;
+}
+
+static void parse_opts(int argc, char **argv, bopts_t *o){
+    memset(o, 0, sizeof *o);
+    o->seed = 1;
+    o->nstates = 16;
+    o->sides[0] = 20; o->sides[1] = 100; o->sides[2] = 1000; o->nsides = 3;
+    o->players[0] = 2; o->players[1] = 4; o->players[2] = 9; o->nplayers = 3;
+    for (int s = 0; s < STRAT_COUNT; ++s) o->strat[o->nstrat++] = (strategy_t)s;
+    o->depth = 3;
+    o->games = 10;
+    o->qside = 20;
+    o->tol = 25.0;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "s:n:w:P:p:D:g:q:o:b:T:")) != -1) {
+        switch (opt) {
+        case 's': o->seed = (unsigned)strtoul(optarg, NULL, 10); break;
+        case 'n': o->nstates = atoi(optarg); break;
+        case 'w': o->nsides = parse_ints(optarg, o->sides, 10, GS_MAX_SIDE); break;
+        case 'P': o->nplayers = parse_ints(optarg, o->players, 1, 9); break;
+        case 'p':
+            o->nstrat = 0;
+            for (char *tok = strtok(optarg, ","); tok; tok = strtok(NULL, ",")) {
+                if (o->nstrat == STRAT_COUNT || strategy_from_name(tok, &o->strat[o->nstrat]) != 0)
+                    die("Estrategia desconocida: %s", tok);
+                o->nstrat++;
+            }
+            break;
+        case 'D': o->depth = atoi(optarg); break;
+        case 'g': o->games = atoi(optarg); break;
+        case 'q': o->qside = atoi(optarg); break;
+        case 'o': o->out = optarg; break;
+        case 'b': o->base = optarg; break;
+        case 'T': o->tol = atof(optarg); break;
+        default: die(USAGE);
+        }
+    }
+    if (o->nstates < 1 || o->nstrat < 1 || o->depth < 1 || o->depth > SEARCH_MAX_DEPTH ||
+        o->games < 0 || o->qside < 10 || o->tol < 0)
+        die(USAGE);
+}
+
+int main(int argc, char **argv){
+    bopts_t o;
+    parse_opts(argc, argv, &o);
+    strategy_set_search_limits(0, o.depth);   // search a profundidad fija: mismo checksum en cada corrida
+
+    printf("semilla %u, %d estados por configuración, search a %d plies\n", o.seed, o.nstates, o.depth);
+    rows_t rows = { NULL, 0, 0 };
+    run_timing(&o, &rows);
+    if (o.games > 0 && o.nstrat > 1) run_playoffs(&o, &rows);
+
+    if (o.out) write_csv(o.out, &rows);
+    int regress = o.base ? compare_base(&o, &rows) : 0;
+    free(rows.v);
+    search_release();
+    return regress ? 1 : 0;
+}
@@ -0,0 +1,146 @@
+#define _DEFAULT_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include <errno.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <sys/mman.h>
+#include <sys/wait.h>
+
+#include "game_utils.h"   // die
+#include "shared_mem.h"   // game_state_t, gs_bytes_for, gs_init_state
+#include "sync_utils.h"   // game_sync_t, gx_init, writer_enter/exit, sync_read_snapshot
+#include "bench_common.h" // now_ns
+
+/*
+ * Benchmark de publicación del estado: lectores–escritor con semáforos vs seqlock.
+ * Un escritor (el "máster") aplica N escrituras mientras R procesos lectores
+ * leen el estado completo en loop (como jugadores/vista). Se mide la espera del
+ * escritor en writer_enter y las lecturas consistentes por segundo.
+ */
+
+#define USAGE "Uso: bench_sync [-r readers] [-n writes] [-w W] [-h H]"
+
+typedef struct {
+    atomic_int stop;
+    atomic_int ready;
+    unsigned long long reads[MAXP];
+} bench_ctl_t;
+
+static void *map_shared(size_t bytes){
+    void *p = mmap(NULL, bytes, PROT_READ|PROT_WRITE, MAP_SHARED|MAP_ANONYMOUS, -1, 0);
+    if (p == MAP_FAILED) die("mmap(%zu): %s", bytes, strerror(errno));
+    memset(p, 0, bytes);
+    return p;
+}
+
+static volatile unsigned long long g_sink; // evita que se optimice el escaneo
+
+// Escaneo completo del board (costo de lectura típico de una estrategia/la vista)
+static unsigned scan_free(const game_state_t *st){
+    unsigned tot = (unsigned)st->width * st->height, n = 0;
+    for (unsigned i = 0; i < tot; ++i) n += st->board[i] > 0;
+    return n;
+}
+
+// Lector: lectura consistente + escaneo del board
+static void reader_loop(game_sync_t *gx, game_state_t *gs, size_t bytes, bench_ctl_t *ctl, int id){
+    game_state_t *snap = malloc(bytes);
+    if (!snap) die_fast("malloc: %s", strerror(errno));
+    unsigned long long n = 0, sink = 0;
+    atomic_fetch_add(&ctl->ready, 1);
+    while (!atomic_load_explicit(&ctl->stop, memory_order_relaxed)) {
+        if (gx->sync_mode == SYNC_SEQLOCK) {
+            sync_read_snapshot(gx, snap, gs, bytes);
+            sink += scan_free(snap);
+        } else {
+            reader_enter(gx);
+            sink += scan_free(gs);
+            reader_exit(gx);
+        }
+        n++;
+    }
+    g_sink = sink;
+    ctl->reads[id] = n;
+    free(snap);
+    _exit(0);
+}
+
+static void run_mode(unsigned mode, int readers, long writes, int W, int H){
+    size_t bytes = gs_bytes_for(W, H, 0);
+    game_state_t *gs = map_shared(bytes);
+    game_sync_t  *gx = map_shared(sizeof(game_sync_t));
+    bench_ctl_t  *ctl = map_shared(sizeof(bench_ctl_t));
+
+    gs_init_state(gs, bytes, W, H, 1, 0);
+    gs_init_board_rewards(gs->board, W, H, 1);
+    gs_rebuild_counters(gs);
+    if (gx_init(gx) != 0) die("gx_init: %s", strerror(errno));
+    gx->sync_mode = mode;
+
+    pid_t pids[MAXP];
+    for (int r = 0; r < readers; ++r) {
+        pids[r] = fork();
+        if (pids[r] < 0) die("fork: %s", strerror(errno));
+        if (pids[r] == 0) reader_loop(gx, gs, bytes, ctl, r);
+    }
+    while (atomic_load(&ctl->ready) < readers) sched_yield();
+
+    // Escritor: cada escritura toca una celda y un jugador (como apply_move_rr)
+    double wait_sum = 0, wait_max = 0;
+    int cells = W * H;
+    double t0 = now_ns();
+    for (long k = 0; k < writes; ++k) {
+        double a = now_ns();
+        writer_enter(gx);
+        double b = now_ns();
+        int c = (int)(k % cells);
+        gs->board[c] = gs->board[c] > 0 ? -(int)(k % 9) : 1 + (int)(k % 9);
+        gs->players[0].score++;
+        gs->players[0].x = (unsigned short)(c % W);
+        gs->players[0].y = (unsigned short)(c / W);
+        writer_exit(gx);
+        double w = b - a;
+        wait_sum += w;
+        if (w > wait_max) wait_max = w;
+    }
+    double secs = (now_ns() - t0) / 1e9;
+
+    atomic_store(&ctl->stop, 1);
+    unsigned long long reads = 0;
+    for (int r = 0; r < readers; ++r) waitpid(pids[r], NULL, 0);
+    for (int r = 0; r < readers; ++r) reads += ctl->reads[r];
+
+    printf("%-4s readers=%d  writes/s=%12.0f  writer_wait avg=%9.0f ns max=%11.0f ns  reads/s=%12.0f\n",
+           mode == SYNC_SEQLOCK ? "seq" : "rw", readers,
+           (double)writes / secs, wait_sum / (double)writes, wait_max, (double)reads / secs);
+
+    gx_destroy_sems(gx);
+    munmap(gs, bytes); munmap(gx, sizeof(game_sync_t)); munmap(ctl, sizeof(bench_ctl_t));
+}
+
+int main(int argc, char **argv){
+    int readers = 9, W = 100, H = 100;
+    long writes = 200000;
+    int opt;
+    while ((opt = getopt(argc, argv, "r:n:w:h:")) != -1) {
+        switch (opt) {
+        case 'r': readers = atoi(optarg); break;
+        case 'n': writes = atol(optarg); break;
+        case 'w': W = atoi(optarg); break;
+        case 'h': H = atoi(optarg); break;
+        default: die(USAGE);
+        }
+    }
+    if (readers < 0 || readers > MAXP) die("readers: 0..%d", MAXP);
+    if (writes < 1 || W < 1 || H < 1) die(USAGE);
+
+    printf("board %dx%d, %ld escrituras\n", W, H, writes);
+    run_mode(SYNC_RWLOCK,  readers, writes, W, H);
+    run_mode(SYNC_SEQLOCK, readers, writes, W, H);
+    return 0;
+}
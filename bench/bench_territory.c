@@ -0,0 +1,164 @@
+#define _DEFAULT_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+
+#include "game_utils.h"         // die, DX/DY
+#include "shared_mem.h"         // gs_cells_t, gs_cell_is_free, gs_free_local
+#include "territory.h"          // terr_win_load, terr_reachable, terr_voronoi
+#include "player_strategies.h"  // pick_move_strategy, STRAT_TERRITORY
+#include "search.h"             // SEARCH_DEFAULT_BUDGET_MS
+#include "bench_common.h"       // now_ns, cmp_double, bench_make_state
+
+/*
+ * Benchmark del kernel de territorio: para cada lado N arma un tablero N×N con ~10% de
+ * celdas capturadas y, en n posiciones al azar, pone al jugador 0 y a los rivales dentro de
+ * su ventana (peor caso: todas las fuentes compiten). Mide terr_reachable, terr_voronoi y la
+ * decisión completa de "territory" (8 Voronoi) contra el presupuesto por jugada, y como
+ * referencia un flood fill de tablero completo con visitados reservados por llamada.
+ * En tableros de hasta TERR_SIDE de lado la ventana cubre todo: el área tiene que coincidir.
+ */
+
+#define USAGE "Uso: bench_territory [-n posiciones] [-p players] [-B budget_us] [side1 side2 ...]"
+
+// Flood fill ingenuo: todo el tablero, visitados en calloc y cola en malloc por llamada
+static unsigned naive_reachable(const gs_cells_t *b, int x, int y){
+    size_t tot = (size_t)b->W * b->H;
+    unsigned char *seen = calloc(tot, 1);
+    unsigned *q = malloc(tot * sizeof *q);
+    if (!seen || !q) die("malloc");
+    size_t head = 0, tail = 0;
+    seen[(size_t)y * b->W + x] = 1;
+    q[tail++] = (unsigned)((size_t)y * b->W + x);
+    while (head < tail) {
+        unsigned k = q[head++];
+        int cx = (int)(k % (unsigned)b->W), cy = (int)(k / (unsigned)b->W);
+        for (int d = 0; d < 8; ++d) {
+            int nx = cx + DX[d], ny = cy + DY[d];
+            if (nx < 0 || ny < 0 || nx >= b->W || ny >= b->H) continue;
+            size_t nk = (size_t)ny * b->W + nx;
+            if (seen[nk] || !gs_cell_is_free(b, nx, ny)) continue;
+            seen[nk] = 1;
+            q[tail++] = (unsigned)nk;
+        }
+    }
+    free(seen);
+    free(q);
+    return (unsigned)(tail - 1);
+}
+
+// Celda capturada al azar (cabeza de jugador) a distancia <= r de (cx,cy); r < 0 = cualquiera
+static void random_head(const gs_cells_t *b, unsigned *rng, int cx, int cy, int r, int *x, int *y){
+    for (;;) {
+        if (r < 0) {
+            *x = (int)(rand_r(rng) % (unsigned)b->W);
+            *y = (int)(rand_r(rng) % (unsigned)b->H);
+        } else {
+            *x = cx - r + (int)(rand_r(rng) % (unsigned)(2 * r + 1));
+            *y = cy - r + (int)(rand_r(rng) % (unsigned)(2 * r + 1));
+            if (*x < 0 || *y < 0 || *x >= b->W || *y >= b->H) continue;
+        }
+        if (!gs_cell_is_free(b, *x, *y)) return;
+    }
+}
+
+// Devuelve 1 si la decisión superó el presupuesto en p99 o el área no coincidió
+static int run_side(int side, unsigned np, int n, double budget_us){
+    // corpus común con ~10% capturado; las cabezas se reubican en cada posición
+    game_state_t *gs = bench_make_state(side, side, np, 10u, 4242u + (unsigned)side, 0);
+    unsigned rng = 977u * (unsigned)side + 1u;
+    gs_cells_t b; gs_cells_bind(&b, gs);
+
+    double *lat = malloc((size_t)n * sizeof *lat);
+    if (!lat) die("malloc");
+    double t_reach = 0, t_vor = 0, t_naive = 0, t_dec = 0;
+    unsigned long area = 0, owned = 0;
+    int mismatch = 0, naive_n = 0;
+    bool exact = side <= TERR_SIDE;
+
+    for (int k = 0; k < n; ++k) {
+        int x, y;
+        random_head(&b, &rng, 0, 0, -1, &x, &y);
+        gs->players[0].x = (unsigned short)x;
+        gs->players[0].y = (unsigned short)y;
+        int sx[TERR_NP], sy[TERR_NP];
+        sx[0] = x; sy[0] = y;
+        for (unsigned p = 1; p < np; ++p) {
+            random_head(&b, &rng, x, y, TERR_RADIUS, &sx[p], &sy[p]);
+            gs->players[p].x = (unsigned short)sx[p];
+            gs->players[p].y = (unsigned short)sy[p];
+        }
+
+        double t0 = now_ns();
+        terr_win_t w;
+        terr_win_load(&w, &b, x, y);
+        unsigned a = terr_reachable(&w, x, y);
+        double t1 = now_ns();
+        terr_count_t c;
+        terr_voronoi(&w, sx, sy, (int)np, &c);
+        double t2 = now_ns();
+        (void)pick_move_strategy(STRAT_TERRITORY, gs, 0);
+        double t3 = now_ns();
+        t_reach += t1 - t0;
+        t_vor += t2 - t1;
+        t_dec += t3 - t2;
+        lat[k] = (t3 - t2) / 1e3;
+        area += a;
+        owned += c.cells[0];
+
+        // el de tablero completo es O(N²) por llamada: unas pocas alcanzan
+        if (exact || naive_n < 3) {
+            double t4 = now_ns();
+            unsigned full = naive_reachable(&b, x, y);
+            t_naive += now_ns() - t4;
+            naive_n++;
+            if (exact && full != a) mismatch++;
+        }
+    }
+
+    qsort(lat, (size_t)n, sizeof *lat, cmp_double);
+    double p99 = lat[(size_t)n * 99 / 100], mx = lat[n - 1];
+    int over = p99 > budget_us;
+    printf("%5dx%-5d reachable %7.0f ns (área media %5.0f)  voronoi %7.0f ns (propias %4.0f)  "
+           "decisión %6.1f us p99 %6.1f máx %6.1f%s  tablero completo %10.0f ns%s\n",
+           side, side, t_reach / n, (double)area / n, t_vor / n, (double)owned / n,
+           t_dec / n / 1e3, p99, mx, over ? " >PRESUPUESTO" : "",
+           t_naive / naive_n, exact ? (mismatch ? "  DIFIERE" : "  (exacto)") : "");
+    free(lat);
+    gs_free_local(gs);
+    return over || mismatch;
+}
+
+int main(int argc, char **argv){
+    int n = 2000;
+    unsigned np = 9;
+    double budget_us = SEARCH_DEFAULT_BUDGET_MS * 1000.0;
+    int opt;
+    while ((opt = getopt(argc, argv, "n:p:B:")) != -1) {
+        switch (opt) {
+        case 'n': n = atoi(optarg); break;
+        case 'p': np = (unsigned)atoi(optarg); break;
+        case 'B': budget_us = atof(optarg); break;
+        default: die(USAGE);
+        }
+    }
+    if (n < 1 || np < 1 || np > 9 || budget_us <= 0) die(USAGE);
+
+    static const int def_sides[] = { 30, 100, 1000, 4000 };
+    printf("ventana %dx%d, %u jugadores, %d posiciones, presupuesto %.0f us/jugada\n",
+           TERR_SIDE, TERR_SIDE, np, n, budget_us);
+    int fail = 0;
+    if (optind < argc) {
+        for (int i = optind; i < argc; ++i) {
+            int side = atoi(argv[i]);
+            if (side < 10 || side > GS_MAX_SIDE) die("lado inválido: %s", argv[i]);
+            fail |= run_side(side, np, n, budget_us);
+        }
+    } else {
+        for (size_t i = 0; i < sizeof def_sides / sizeof def_sides[0]; ++i)
+            fail |= run_side(def_sides[i], np, n, budget_us);
+    }
+    return fail;
+}
@@ -0,0 +1,60 @@
+#ifndef BITBOARD_H
+#define BITBOARD_H
+
+#pragma once
+#include <stdint.h>
+#include "shared_mem.h"   // gs_cells_t, GS_BITS_PAD
+
+/* ===== Bitboard de celdas libres =====
+   Kernels sobre el bitmap de la zona extendida (fila y+GS_BITS_PAD, bit x+GS_BITS_PAD).
+   El marco de GS_BITS_PAD celdas está siempre en 0: ninguna consulta de hasta 3 celdas
+   alrededor de una celda del tablero necesita chequear bordes. */
+
+/* n (<= 57) bits de la fila y a partir de la columna x (x >= -GS_BITS_PAD); bit 0 = columna x */
+static inline uint64_t bb_row_bits(const gs_cells_t *c, int x, int y, unsigned n){
+    const uint64_t *row = c->bits + (size_t)(y + GS_BITS_PAD) * c->stride;
+    unsigned bx = (unsigned)(x + GS_BITS_PAD), w = bx >> 6, s = bx & 63u;
+    uint64_t v = row[w] >> s;
+    if (s + n > 64u) v |= row[w + 1] << (64u - s);
+    return v & ((1ull << n) - 1u);
+}
+
+/* Ventana 7x7 centrada en (x,y): bit (dy+3)*8 + (dx+3) para dx,dy ∈ [-3,3].
+   Con filas de 8 bits, desplazar una máscara dy*8+dx la recentra sin mezclar filas. */
+static inline uint64_t bb_patch7(const gs_cells_t *c, int x, int y){
+    uint64_t p = 0;
+    for (int r = 0; r < 7; ++r) p |= bb_row_bits(c, x - 3, y - 3 + r, 7) << (r * 8);
+    return p;
+}
+
+#define BB_P(dx, dy)  (1ull << (((dy) + 3) * 8 + (dx) + 3))
+#define BB_RING1      0x0000001C141C0000ull  /* 8 vecinos de (0,0) en la ventana */
+#define BB_RING2      0x00003E2222223E00ull  /* borde 5x5 alrededor de (0,0) */
+
+/* Máscara centrada en (0,0) recentrada en (dx,dy), |dx|,|dy| <= 1 */
+static inline uint64_t bb_shift(uint64_t m, int dx, int dy){
+    int s = dy * 8 + dx;
+    return s >= 0 ? m << s : m >> -s;
+}
+
+/* Libres de la máscara centrada en (dx,dy) dentro de la ventana */
+static inline int bb_count(uint64_t patch, uint64_t mask, int dx, int dy){
+    return __builtin_popcountll(patch & bb_shift(mask, dx, dy));
+}
+
+/* Vecinos libres de (x,y) (0..8) con 3 extracciones de fila y un popcount */
+static inline int bb_mobility_at(const gs_cells_t *c, int x, int y){
+    uint64_t m = bb_row_bits(c, x - 1, y - 1, 3)
+               | (bb_row_bits(c, x - 1, y, 3) & 5u) << 3
+               | bb_row_bits(c, x - 1, y + 1, 3) << 6;
+    return __builtin_popcountll(m);
+}
+
+/* Vecinos libres de cada celda de las filas [y0, y1): out[(y-y0)*W + x].
+   Suma bit-sliced de los 8 vecinos, 64 celdas por palabra (SWAR). */
+void bb_mobility_rows(const gs_cells_t *c, int y0, int y1, unsigned char *out);
+
+/* Celdas libres en las filas [y0, y1) (popcount por palabra). */
+unsigned int bb_count_free_rows(const gs_cells_t *c, int y0, int y1);
+
+#endif
@@ -0,0 +1,55 @@
+#ifndef EVENT_LOOP_H
+#define EVENT_LOOP_H
+
+#pragma once
+#include <signal.h>
+#include <time.h>
+
+/* ===== Backend de eventos del master (epoll + timerfd + signalfd) =====
+   Los FDs se registran una sola vez; el timeout de inactividad es un deadline
+   absoluto en un timerfd y las señales llegan como eventos (signalfd). */
+
+typedef struct {
+    int epfd;   /* epoll */
+    int tfd;    /* timerfd CLOCK_MONOTONIC (deadline de inactividad) */
+    int sfd;    /* signalfd de las señales bloqueadas */
+} ev_loop_t;
+
+typedef enum {
+    EV_FD = 0,      /* FD registrado listo para leer (tag = el del registro) */
+    EV_TIMER,       /* venció el deadline */
+    EV_SIGNAL       /* hay señal pendiente en el signalfd */
+} ev_kind_t;
+
+typedef struct {
+    ev_kind_t kind;
+    int tag;
+} ev_event_t;
+
+/* Bloquea `sigs` (guardando la máscara previa en *old_mask si no es NULL) y crea
+   epoll/timerfd/signalfd con CLOEXEC. Devuelve 0 si ok. */
+int  ev_open(ev_loop_t *ev, const sigset_t *sigs, sigset_t *old_mask);
+
+/* Cierra los tres FDs (no toca la máscara de señales). */
+void ev_close(ev_loop_t *ev);
+
+/* Registra fd (lectura, level-triggered) con un tag propio. Devuelve 0 si ok. */
+int  ev_add_fd(ev_loop_t *ev, int fd, int tag);
+
+/* Desregistra fd (antes de cerrarlo). Devuelve 0 si ok. */
+int  ev_del_fd(ev_loop_t *ev, int fd);
+
+/* Arma el timerfd a un instante absoluto de CLOCK_MONOTONIC. Devuelve 0 si ok. */
+int  ev_set_deadline(ev_loop_t *ev, const struct timespec *abs_deadline);
+
+/* Consume la expiración del timerfd (llamar tras un EV_TIMER). */
+void ev_timer_ack(ev_loop_t *ev);
+
+/* Lee una señal del signalfd. Devuelve el número de señal, 0 si no había, -1 si error. */
+int  ev_read_signal(ev_loop_t *ev);
+
+/* Espera eventos (timeout_ms < 0 => sin límite). Reintenta si EINTR.
+   Devuelve la cantidad de eventos escritos en out, 0 si venció timeout_ms, -1 si error. */
+int  ev_wait(ev_loop_t *ev, ev_event_t *out, int max, int timeout_ms);
+
+#endif
@@ -15,6 +15,14 @@ const char* base_name(const char *path);
 // setea/limpia el flag FD_CLOEXEC
 void set_cloexec(int fd, int on);
 
+/* Namespace de los segmentos compartidos: con SHM_NS_ENV=".g7" el estado es "/game_state.g7"
+   (y lo mismo /game_sync). Sin la variable quedan los nombres fijos de la cátedra. Los hijos
+   la heredan, así varias partidas conviven en un mismo host. */
+#define SHM_NS_ENV "CHOMP_SHM_NS"
+#define SHM_NS_MAX 48
+// base + sufijo del namespace en buf (el sufijo se ignora si es inválido o muy largo)
+const char *shm_ns_name(const char *base, char *buf, size_t n);
+
 /* Geometría del tablero */
 extern const int DX[8];
 extern const int DY[8];
@@ -31,6 +39,7 @@ static inline int idx_wh(int x, int y, int W){
 }
 
 /* Protocolo por pipe: 1 byte dirección (0..7) */
+/* 0 ok, 1 EOF, 2 sin datos (EAGAIN en fd no bloqueante), -1 error */
 int  proto_read_dir (int fd, unsigned char *dir_out);
 int  proto_write_dir(int fd, unsigned char dir);
 static inline int dir_is_valid(unsigned char d){ return d <= 7; }
@@ -0,0 +1,33 @@
+#ifndef LAT_HIST_H
+#define LAT_HIST_H
+
+#pragma once
+#include <stdint.h>
+
+/* ===== Histogramas de latencia (estilo HDR) =====
+   Buckets log-lineales en ns: HIST_SUB sub-buckets por potencia de 2, así el error
+   relativo de cualquier percentil es <= 1/HIST_SUB en todo el rango [0, 2^HIST_MAX_EXP).
+   Registrar es un clz y un incremento, sin reservas: apto para el camino caliente. */
+
+#define HIST_SUB_BITS 5
+#define HIST_SUB      (1u << HIST_SUB_BITS)                          /* 32 => error <= ~3% */
+#define HIST_MAX_EXP  40                                             /* 2^40 ns ~ 18 min */
+#define HIST_BUCKETS  ((HIST_MAX_EXP - HIST_SUB_BITS + 1) * HIST_SUB)
+
+typedef struct {
+    uint64_t count;
+    uint64_t sum_ns, min_ns, max_ns;
+    uint32_t b[HIST_BUCKETS];
+} lat_hist_t;
+
+/* Suma una muestra (los valores fuera de rango caen en el último bucket). */
+void hist_record(lat_hist_t *h, uint64_t ns);
+
+/* Valor del percentil q ∈ [0,1]: cota superior del bucket que lo contiene, acotada a
+   [min, max] de las muestras. 0 si el histograma está vacío. */
+uint64_t hist_percentile(const lat_hist_t *h, double q);
+
+/* Media en ns (0 si está vacío). */
+double hist_mean(const lat_hist_t *h);
+
+#endif
@@ -0,0 +1,82 @@
+#ifndef MOVE_LOG_H
+#define MOVE_LOG_H
+
+#pragma once
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "sync_utils.h"   // MAXP
+
+/* ===== Log binario de partida (master -R / -r) =====
+   Encabezado fijo (semilla, dimensiones, jugadores) y después un registro de 2 bytes por
+   evento aplicado al estado, en el orden exacto en que el máster los aplicó:
+     {i, dir}               jugada del jugador i (se aplica tal cual, válida o no)
+     {MLOG_QUIT | i, 0}     el jugador i se retiró (EOF): queda bloqueado
+     {MLOG_FRAME, mark}     publicación a la vista; mark = 1 si antes corrió gs_mark_blocked_players
+     {MLOG_END, 0}          fin, seguido del resultado (mlog_result_t por jugador) para verificar
+   Con la misma semilla el tablero y la ubicación inicial son idénticos, así que reaplicar
+   los registros reproduce la partida sin jugadores. */
+
+#define MLOG_MAGIC   "CHOMPLOG"
+#define MLOG_VERSION 1u
+#define MLOG_QUIT    0x40u
+#define MLOG_FRAME   0xF0u
+#define MLOG_END     0xFFu
+#define MLOG_BUF     (64u * 1024u)   /* el writer solo hace write(2) cada 32K eventos */
+
+typedef struct {
+    char magic[8];
+    uint32_t version;
+    uint32_t seed;
+    uint16_t width, height;
+    uint8_t nplayers;
+    uint8_t flags;                  /* GS_F_* con que se creó /game_state */
+    uint16_t reserved;
+    char names[MAXP][16];
+} mlog_header_t;
+
+typedef struct {
+    uint32_t score, valid_moves, invalid_moves;
+} mlog_result_t;
+
+/* ===== escritura (máster) ===== */
+typedef struct {
+    int fd;                         /* -1 => deshabilitado */
+    size_t len;                     /* bytes pendientes en buf */
+    unsigned long events;
+    unsigned char buf[MLOG_BUF];
+} mlog_writer_t;
+
+/* Crea/trunca path y escribe el encabezado. Devuelve 0 si ok (-1 y errno si no). */
+int  mlog_open_write(mlog_writer_t *w, const char *path, const mlog_header_t *h);
+/* Vacía el buffer al archivo. Devuelve 0 si ok; si falla deshabilita el writer. */
+int  mlog_flush(mlog_writer_t *w);
+/* Registro MLOG_END + resultados, flush y close. Devuelve 0 si todo se escribió. */
+int  mlog_close(mlog_writer_t *w, const mlog_result_t *res, int nplayers);
+
+/* Camino caliente: dos stores en memoria (y un write(2) cada MLOG_BUF bytes). */
+static inline void mlog_put(mlog_writer_t *w, unsigned a, unsigned b){
+    if (w->fd < 0) return;
+    if (w->len + 2u > MLOG_BUF && mlog_flush(w) != 0) return;
+    w->buf[w->len++] = (unsigned char)a;
+    w->buf[w->len++] = (unsigned char)b;
+    w->events++;
+}
+
+/* ===== lectura (replay) ===== */
+typedef struct {
+    void *map; size_t map_bytes;
+    const mlog_header_t *hdr;
+    const unsigned char *rec;       /* registros de 2 bytes */
+    size_t nrec;                    /* hasta MLOG_END (sin incluirlo) */
+    const unsigned char *result;    /* mlog_result_t por jugador (sin alinear); NULL si el log
+                                       quedó truncado (sin MLOG_END) */
+} mlog_reader_t;
+
+/* mmap de solo lectura y validación del encabezado. Devuelve 0 si ok (-1 y errno si no). */
+int  mlog_open_read(mlog_reader_t *r, const char *path);
+void mlog_close_read(mlog_reader_t *r);
+/* Resultado grabado del jugador i. false si el log no lo tiene. */
+bool mlog_result_of(const mlog_reader_t *r, int i, mlog_result_t *out);
+
+#endif
@@ -0,0 +1,52 @@
+#ifndef PLAYER_POOL_H
+#define PLAYER_POOL_H
+
+#pragma once
+#include <stddef.h>
+#include <stdatomic.h>
+#include "game_utils.h"   // SHM_NS_MAX
+
+/* ===== Pool de jugadores persistentes (master -S -k) =====
+   El servidor lanza una vez un jugador por slot (jobs x jugadores) y los reusa en todas las
+   partidas. Cada slot es un buzón en shm: el máster de la partida escribe el namespace y el
+   índice del jugador y avanza `seq` (futex); el jugador abre el estado de esa partida, juega,
+   lo suelta y publica `done = seq` (futex). Sin fork/exec ni búsqueda por pid por partida. */
+
+#define SHM_POOL      "/game_pool"
+#define POOL_ENV      "CHOMP_POOL"        /* nombre del segmento: el jugador corre en modo pool */
+#define POOL_SLOT_ENV "CHOMP_POOL_SLOT"   /* slot del jugador */
+
+#define POOL_GAME 1u   /* nueva partida: ns e index válidos */
+#define POOL_EXIT 2u   /* el servidor termina: salir */
+
+typedef struct {
+    _Alignas(64) atomic_uint seq;   /* máster → jugador: cambia con cada aviso */
+    atomic_uint done;               /* jugador → máster: último seq atendido */
+    atomic_uint cmd;                /* POOL_GAME / POOL_EXIT del último aviso */
+    atomic_int pid;                 /* jugador del slot (0 = sin lanzar) */
+    int index;                      /* su índice en players[] en esta partida */
+    char ns[SHM_NS_MAX + 1];        /* namespace de shm de la partida */
+} pool_slot_t;
+
+typedef struct {
+    unsigned nslots;
+    pool_slot_t slot[];
+} player_pool_t;
+
+/* Crea el segmento `name` con nslots slots en cero (servidor). Devuelve 0 si ok (-1 y errno). */
+int  pool_create(player_pool_t **out, size_t *bytes, const char *name, unsigned nslots);
+/* Abre en RW un pool existente (jugador). Devuelve 0 si ok (-1 y errno). */
+int  pool_open(player_pool_t **out, size_t *bytes, const char *name);
+void pool_close(player_pool_t *p, size_t bytes);
+
+/* Máster: publica un aviso en el slot y despierta al jugador. Devuelve el seq del aviso. */
+unsigned pool_post(pool_slot_t *s, unsigned cmd, const char *ns, int index);
+/* Máster: espera done == seq. 0 si llegó, -1 si venció timeout_ms (< 0 => sin límite). */
+int  pool_wait_done(pool_slot_t *s, unsigned seq, int timeout_ms);
+
+/* Jugador: espera un aviso con seq != seen (sin límite) y devuelve su seq. */
+unsigned pool_wait(pool_slot_t *s, unsigned seen);
+/* Jugador: terminó el aviso seq (ya no toca el estado de esa partida). */
+void pool_done(pool_slot_t *s, unsigned seq);
+
+#endif
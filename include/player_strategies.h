@@ -17,16 +17,41 @@ typedef enum {
     STRAT_CUTOFF,               // intenta quitar movilidad a rivales cercanos
     STRAT_TWO_PLY_LIGHT,        // 2-ply muy liviano (tu jugada + movilidad resultante)
     STRAT_ENDGAME_HARVEST,      // en endgame, prioriza valores altos cercanos
-    STRAT_RANDOM_TIEBREAK       // igual a greedy pero rompe empates al azar
+    STRAT_RANDOM_TIEBREAK,      // igual a greedy pero rompe empates al azar
+    STRAT_SEARCH,               // alpha-beta paranoica con profundización iterativa (search.h)
+    STRAT_TERRITORY,            // Voronoi por flood fill: celdas que alcanzo antes que los rivales (territory.h)
+    STRAT_COUNT                 // cantidad de estrategias (no es una estrategia)
 } strategy_t;
 
+// Nombre corto de la estrategia ("greedy", "space", ...) y parseo inverso.
+const char *strategy_name(strategy_t strat);
+// Devuelve 0 y escribe *out si el nombre existe; -1 si no.
+int strategy_from_name(const char *name, strategy_t *out);
+
 // Decide estrategia inicial dado tablero/jugadores/índice
 strategy_t choose_strategy(unsigned short W, unsigned short H, unsigned int num_players, int myi);
 
+// Presupuesto por jugada (ms, 0 = sin reloj) y tope de plies (0 = default) de STRAT_SEARCH.
+// Global al proceso: llamar antes de lanzar hilos.
+void strategy_set_search_limits(unsigned budget_ms, int max_depth);
+
+// Reparte la raíz de STRAT_SEARCH en un pool de nthreads hilos (contando al llamador), creado
+// una sola vez por proceso; un solo hilo puede decidir con search a la vez. Devuelve los hilos.
+// Con nthreads <= 1 no crea pool: search sigue secuencial.
+int strategy_set_search_threads(int nthreads);
+
+// Filas alrededor del jugador que lee la estrategia en un tablero de H filas (copia parcial
+// del estado); -1 = todas.
+int strategy_rows(strategy_t strat, unsigned short H);
+
 // ¿Conviene pasar a endgame?
 bool should_switch_to_endgame(unsigned int free_cells, unsigned int total_cells);
 
 // API principal: dir 0..7 o 255 si no hay jugada válida
 unsigned char pick_move_strategy(strategy_t strat, const game_state_t *gs, int player_idx);
 
+// Igual, con los desempates al azar de "random" tomados de *rng (rand_r) en vez de rand():
+// reproducible y sin el lock de libc cuando varios hilos deciden a la vez.
+unsigned char pick_move_strategy_r(strategy_t strat, const game_state_t *gs, int player_idx, unsigned *rng);
+
 #endif
@@ -0,0 +1,61 @@
+#ifndef SEARCH_H
+#define SEARCH_H
+
+#pragma once
+#include "shared_mem.h"   // game_state_t
+
+/* ===== Búsqueda multi-ply (STRAT_SEARCH) =====
+   Alpha-beta paranoica sobre todos los jugadores: el jugador propio maximiza y el
+   resto minimiza su evaluación. Profundización iterativa hasta agotar el presupuesto,
+   make/unmake sobre una copia privada del bitmap de libres (sin reservas por nodo)
+   y tabla de transposición con claves Zobrist. */
+
+#define SEARCH_DEFAULT_BUDGET_MS 10
+#define SEARCH_MAX_DEPTH         64
+
+typedef struct {
+    unsigned budget_us;     /* presupuesto por jugada (la profundidad 1 siempre se completa);
+                               0 = sin reloj, solo max_depth (determinista) */
+    int max_depth;          /* tope de plies (1..SEARCH_MAX_DEPTH) */
+} search_limits_t;
+
+/* Estadísticas de la última decisión del hilo (para logs/benchmarks). */
+typedef struct {
+    int depth;              /* última profundidad completa */
+    unsigned long nodes;    /* nodos visitados */
+    unsigned long tt_hits;  /* cortes/valores servidos por la tabla */
+    unsigned elapsed_us;
+} search_stats_t;
+
+/* dir 0..7 o 255 si no hay jugada. Reserva el contexto del hilo la primera vez. */
+unsigned char search_pick(const game_state_t *gs, int me, const search_limits_t *lim);
+
+/* Estadísticas de la última search_pick del hilo llamador. */
+search_stats_t search_last_stats(void);
+
+/* Libera el contexto (tabla + tablero privado) del hilo llamador. */
+void search_release(void);
+
+/* ===== Búsqueda paralela por jugada raíz =====
+   Pool fijo de hilos creado una vez. En cada iteración de la profundización el llamador
+   evalúa sola la primera jugada raíz (ventana completa) y después reparte las demás entre
+   los hilos (él también trabaja), todas con ventana (valor de la primera, +inf) sobre el
+   tablero privado y la tabla de su hilo. Cada hilo carga el tablero y saca sal una vez por
+   decisión, así que su tabla sirve entre jugadas raíz e iteraciones. La mejor jugada de una
+   iteración abre la siguiente, como la jugada de tabla en search_pick: con presupuesto 0
+   (profundidad fija) se elige lo mismo que search_pick (bench_search_threads lo verifica). */
+#define SEARCH_MAX_THREADS 16
+
+typedef struct search_pool search_pool_t;
+
+/* nthreads en total, contando al llamador (1..SEARCH_MAX_THREADS). NULL sin memoria. */
+search_pool_t *search_pool_create(int nthreads);
+void search_pool_destroy(search_pool_t *p);
+/* Hilos que efectivamente quedaron (pthread_create puede fallar). */
+int  search_pool_threads(const search_pool_t *p);
+
+/* Como search_pick, con la raíz repartida en el pool. Un solo llamador a la vez por pool.
+   Sin pool o con un solo hilo es search_pick. */
+unsigned char search_pick_parallel(search_pool_t *p, const game_state_t *gs, int me, const search_limits_t *lim);
+
+#endif
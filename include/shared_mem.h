@@ -3,12 +3,23 @@
 
 #pragma once
 #include <stdbool.h>
+#include <stdint.h>
 #include <sys/types.h>
 #include <stddef.h>
 
 //Segmento de ESTADO del juego 
 #define SHM_STATE "/game_state"
 
+/* Límites del tablero: width/height siguen siendo unsigned short (layout de la cátedra) */
+#define GS_MAX_SIDE  65535
+#define GS_MAX_CELLS (1u << 26)     /* ~67M celdas (~320 MiB de shm) */
+
+/* Flags de gs_create_and_init */
+#define GS_F_HUGEPAGES 0x1u          /* madvise(MADV_HUGEPAGE) sobre /game_state */
+#define GS_F_COMPACT   0x2u          /* espejo compacto: 1 byte/celda */
+#define GS_F_SHADOW    0x4u          /* (solo lectores) copia local de un /game_state sin zona extendida */
+#define GS_HUGEPAGE    (2u << 20)
+
 //Información de un jugador (igual a tu structs.h, sin cambios de campos)
 typedef struct {
     char name[16];
@@ -30,14 +41,124 @@ typedef struct {
     int board[];       /* fila-0, fila-1, ..., fila-(h-1) */
 } game_state_t;
 
+/* ===== Zona extendida: después del board, alineada a 64 =====
+   No es parte del layout de la cátedra (los binarios oficiales ven el mismo prefijo).
+   Solo la escribe el máster, dentro de writer_enter/exit, junto con el board. */
+#define GS_EXT_MAGIC 0x43484f4du    /* "CHOM" */
+
+typedef struct {
+    unsigned int magic;         /* GS_EXT_MAGIC */
+    unsigned int free_cells;    /* # celdas con recompensa (board > 0) */
+    unsigned int nbrs_off;      /* offset desde el ext de free_nbrs[W*H]: # vecinos libres (0..8) */
+    unsigned int flags;         /* GS_F_* de la zona (GS_F_COMPACT => cells presente) */
+    unsigned int cells_off;     /* offset de cells[W*H] (1 byte/celda) o 0 */
+    unsigned int bits_off;      /* offset del bitmap de libres (siempre presente) */
+    unsigned int bits_stride;   /* palabras de 64 bits por fila del bitmap */
+    unsigned int dirty_off;     /* offset del ring de celdas cambiadas (índices y*W+x) */
+    unsigned int dirty_head;    /* # celdas anotadas desde el inicio; el ring guarda las últimas GS_DIRTY_CAP */
+} gs_ext_t;
+
+/* ===== Celda compacta: nibble bajo = recompensa 1..9, nibble alto = dueño+1 (0 = libre) =====
+   El board int de la cátedra sigue siendo la fuente de verdad para binarios externos;
+   el espejo lo mantiene el máster en la misma sección crítica que el board. */
+#define GS_CELL_REWARD(c)   ((int)((c) & 0x0Fu))
+#define GS_CELL_FREE(c)     (((c) & 0xF0u) == 0)
+#define GS_CELL_OWNER(c)    ((int)((c) >> 4) - 1)
+#define GS_CELL_PACK(r, o)  ((unsigned char)((((unsigned)(o) + 1u) << 4) | ((unsigned)(r) & 0x0Fu)))
+
+/* Bitmap de libres: fila y+GS_BITS_PAD, bit x+GS_BITS_PAD; el marco de 3 celdas
+   queda en 0, así que los anillos 1 a 3 alrededor de una celda no chequean bordes
+   (kernels en bitboard.h). */
+#define GS_BITS_PAD 3
+
+/* Ring de celdas cambiadas (capturas y celdas que dejan de ser cabeza), para que la vista
+   redibuje solo eso: quien guardó el dirty_head de su último frame lee las entradas
+   [visto, dirty_head) módulo GS_DIRTY_CAP; si se atrasó más de GS_DIRTY_CAP, redibuja todo. */
+#define GS_DIRTY_CAP 4096u          /* potencia de 2 */
+
+static inline size_t gs_ext_offset(int W, int H){
+    return (sizeof(game_state_t) + (size_t)W * (size_t)H * sizeof(int) + 63u) & ~(size_t)63u;
+}
+static inline gs_ext_t *gs_ext(const game_state_t *gs){
+    return (gs_ext_t *)((char *)gs + gs_ext_offset(gs->width, gs->height));
+}
+static inline unsigned char *gs_free_nbrs(const game_state_t *gs){
+    gs_ext_t *e = gs_ext(gs);
+    return (unsigned char *)e + e->nbrs_off;
+}
+
+static inline const uint32_t *gs_dirty_ring(const game_state_t *gs){
+    const gs_ext_t *e = gs_ext(gs);
+    return (const uint32_t *)((const char *)e + e->dirty_off);
+}
+
+/* Vista de lectura del tablero: resuelve offsets una vez y esconde el encoding.
+   Libre/ocupada sale del bitmap; valores del espejo compacto si existe, si no del board int. */
+typedef struct {
+    int W, H;
+    const int *board;               /* layout de la cátedra (siempre presente) */
+    const unsigned char *cells;     /* espejo compacto o NULL */
+    const uint64_t *bits;           /* bitmap de libres con padding */
+    unsigned int stride;            /* palabras por fila del bitmap */
+} gs_cells_t;
+
+static inline void gs_cells_bind(gs_cells_t *c, const game_state_t *gs){
+    const gs_ext_t *e = gs_ext(gs);
+    c->W = gs->width; c->H = gs->height;
+    c->board = gs->board;
+    c->cells = e->cells_off ? (const unsigned char *)e + e->cells_off : NULL;
+    c->bits  = (const uint64_t *)((const char *)e + e->bits_off);
+    c->stride = e->bits_stride;
+}
+
+/* ¿(x,y) está dentro y libre? Vale para x∈[-3,W+2], y∈[-3,H+2] sin chequear bordes. */
+static inline bool gs_cell_is_free(const gs_cells_t *c, int x, int y){
+    unsigned bx = (unsigned)(x + GS_BITS_PAD);
+    size_t row = (size_t)(y + GS_BITS_PAD) * c->stride;
+    return (c->bits[row + (bx >> 6)] >> (bx & 63u)) & 1u;
+}
+
+/* Valor con la semántica del board int: recompensa si libre, -dueño si capturada. (x,y) dentro. */
+static inline int gs_cell_value(const gs_cells_t *c, int x, int y){
+    size_t i = (size_t)y * c->W + x;
+    if (c->cells) {
+        unsigned char v = c->cells[i];
+        return GS_CELL_FREE(v) ? GS_CELL_REWARD(v) : -GS_CELL_OWNER(v);
+    }
+    return c->board[i];
+}
+
 /* API estado (SHM /game_state) */
 
-/* Crea, trunca e inicializa el estado (solo master). Devuelve 0 si ok. */
-int gs_create_and_init(int W, int H, unsigned nplayers, game_state_t **gs_out, size_t *gs_bytes_out);
+/* Nombre del segmento con el namespace del proceso (SHM_STATE + $CHOMP_SHM_NS). */
+const char *gs_shm_name(char *buf, size_t n);
+
+/* Crea, trunca e inicializa el estado (solo master). flags: GS_F_*. Devuelve 0 si ok. */
+int gs_create_and_init(int W, int H, unsigned nplayers, unsigned flags, game_state_t **gs_out, size_t *gs_bytes_out);
+
+/* Bytes que ocupa un estado WxH (encabezado + board + zona extendida según GS_F_COMPACT). */
+size_t gs_bytes_for(int W, int H, unsigned flags);
+
+/* Inicializa encabezado y zona extendida sobre memoria ya reservada de gs_bytes_for(W,H,flags). */
+void gs_init_state(game_state_t *gs, size_t bytes, int W, int H, unsigned nplayers, unsigned flags);
 
-/* Abre en solo-lectura el estado (view y player). Devuelve 0 si ok. */
+/* Recalcula bitmap, free_cells, free_nbrs y el espejo compacto desde el board (O(W·H); tras escribir el board a mano). */
+void gs_rebuild_counters(game_state_t *gs);
+
+/* Reserva un estado privado en heap (tournament/simulaciones, sin shm). Devuelve 0 si ok. */
+int gs_alloc_local(int W, int H, unsigned nplayers, unsigned flags, game_state_t **gs_out, size_t *gs_bytes_out);
+void gs_free_local(game_state_t *gs);
+
+/* Abre en solo-lectura el estado (view y player). Devuelve 0 si ok.
+   Si el segmento no tiene zona extendida (un máster con el layout de la cátedra), devuelve una
+   sombra privada con el layout completo (GS_F_SHADOW): gs_ro_refresh la rearma desde el board. */
 int gs_open_ro(game_state_t **gs_out, size_t *gs_bytes_out);
 
+/* Sombra (GS_F_SHADOW): vuelve a copiar encabezado y board del segmento y recalcula bitmap y
+   contadores escaneando el tablero (O(W·H)); la vista lo redibuja entero. Con el lock de lector
+   tomado. Sobre un estado con zona extendida propia no hace nada. */
+void gs_ro_refresh(game_state_t *gs);
+
 /* Unmap/cierre simétrico del estado. */
 void gs_close(game_state_t *gs, size_t gs_bytes);
 
@@ -47,10 +168,24 @@ void gs_init_board_rewards(int *board, int W, int H, unsigned seed);
 /* Embaraja y posiciona jugadores en celdas libres */
 int gs_place_players(game_state_t *gs); /* usa width/height/num_players/board */
 
-/* Queries/ops sobre el estado */
+/* Variantes reentrantes (estado de rand_r propio, seguras entre hilos). */
+void gs_init_board_rewards_r(int *board, int W, int H, unsigned *rng);
+int  gs_place_players_r(game_state_t *gs, unsigned *rng);
+
+/* Aplica dir al jugador i sin tomar locks (el caller sincroniza).
+   Suma recompensa y captura si es válido; si no, cuenta movimiento inválido. */
+bool gs_apply_move(game_state_t *gs, int i, unsigned char dir);
+
+/* Queries/ops sobre el estado (O(1) por jugador: leen los contadores de la zona extendida) */
 bool gs_has_valid_move_from(const game_state_t *gs, int x, int y);
 bool gs_any_player_can_move(const game_state_t *gs);
 void gs_mark_blocked_players(game_state_t *gs);
 unsigned int gs_count_free_cells(const game_state_t *gs);
 
+/* Copia parcial a un estado privado con el mismo layout (p.ej. un jugador que decide sin retener
+   el lock): encabezado, players, zona ext y las filas [y0,y1) (recortadas al tablero) de board,
+   free_nbrs, bitmap y espejo compacto. dst tiene que venir de una copia completa previa: las
+   demás filas quedan como estaban. El caller sincroniza la lectura. Devuelve los bytes copiados. */
+size_t gs_copy_rows(game_state_t *dst, const game_state_t *src, int y0, int y1);
+
 #endif
\ No newline at end of file
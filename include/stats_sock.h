@@ -0,0 +1,36 @@
+#ifndef STATS_SOCK_H
+#define STATS_SOCK_H
+
+#pragma once
+#include <stddef.h>
+#include <sys/un.h>
+
+/* ===== Socket de estadísticas en vivo (master -u) =====
+   Socket Unix SOCK_STREAM de solo lectura para monitoreo: el máster acepta clientes desde
+   su event loop y les manda líneas de texto sin bloquearse nunca. Un cliente que cerró o
+   que no lee a tiempo (buffer lleno => EAGAIN) se descarta: no puede frenar la partida. */
+
+#define SS_MAX_CLIENTS 8
+
+typedef struct {
+    int lfd;                        /* socket de escucha (-1 => cerrado) */
+    int cli[SS_MAX_CLIENTS];
+    int ncli;
+    char path[sizeof(((struct sockaddr_un *)0)->sun_path)];
+} stats_sock_t;
+
+/* socket + bind + listen (no bloqueante, CLOEXEC); reemplaza un socket viejo en path.
+   Devuelve 0 si ok (-1 y errno si no). */
+int  ss_open(stats_sock_t *s, const char *path);
+
+/* Acepta todos los clientes pendientes (llamar cuando lfd está listo). Devuelve cuántos. */
+int  ss_accept(stats_sock_t *s);
+
+/* Manda buf completo a cada cliente (MSG_DONTWAIT | MSG_NOSIGNAL); descarta los que fallen
+   o no lo acepten entero. Devuelve cuántos clientes lo recibieron. */
+int  ss_broadcast(stats_sock_t *s, const char *buf, size_t len);
+
+/* Cierra clientes y escucha y borra el path. */
+void ss_close(stats_sock_t *s);
+
+#endif
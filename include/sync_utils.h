@@ -5,11 +5,61 @@
 #include <semaphore.h>
 #include <signal.h>
 #include <stdbool.h>
+#include <stddef.h>
+#include <stdatomic.h>
 
 /* ===== Segmento de SINCRONIZACIÓN ===== */
 #define SHM_SYNC "/game_sync"
 #define MAXP 9
 
+/* Modo de publicación del estado (gx->sync_mode) */
+#define SYNC_RWLOCK  0u   /* lectores–escritor con semáforos (default) */
+#define SYNC_SEQLOCK 1u   /* seqlock: lectores copian sin bloquear al máster */
+
+/* Transporte de turnos jugador ↔ máster (gx->transport) */
+#define XPORT_PIPE  0u    /* movement[i] + 1 byte por pipe (default) */
+#define XPORT_FUTEX 1u    /* buzón por jugador en shm + futex wait/wake */
+
+/* Sincronización máster → vista (gx->view_mode) */
+#define VIEW_SYNC  0u     /* el máster espera state_rendered tras cada cambio (default) */
+#define VIEW_ASYNC 1u     /* el máster solo avisa; la vista dibuja el último estado a view_fps */
+
+/* Palabra del buzón: estado en los bits altos, dirección en el byte bajo */
+#define MBOX_IDLE   0x000u   /* sin permiso */
+#define MBOX_GRANT  0x100u   /* máster → jugador: podés mandar 1 movimiento */
+#define MBOX_REPLY  0x200u   /* jugador → máster: MBOX_REPLY | dir */
+#define MBOX_CLOSED 0x400u   /* jugador → máster: se retira (equivale a EOF) */
+
+/* Un slot por jugador, cada uno en su propia línea de caché */
+typedef struct {
+    _Alignas(64) atomic_uint word;  /* MBOX_* */
+    atomic_uint sleeping;           /* el jugador duerme en futex(word) */
+    atomic_ullong replied_ns;       /* CLOCK_MONOTONIC de su última jugada (ambos transportes) */
+} player_mbox_t;
+
+/* ===== Perfil de contención (build instrumentado: make PROF=1 => -DSYNC_PROF) =====
+   Un slot por proceso con las esperas y retenciones del lock de estado. Cada slot lo escribe
+   un único proceso (el que hizo sync_prof_bind) y cualquiera lo lee en vivo (src/syncstat).
+   Sin SYNC_PROF el bloque existe igual (mismo layout) pero queda en cero. */
+#define PROF_SLOT_MASTER    0
+#define PROF_SLOT_VIEW      1
+#define PROF_SLOT_PLAYER(i) (2 + (i))
+#define PROF_SLOTS          (2 + MAXP)
+#define PROF_STARVE_NS      1000000ull   /* espera de escritor que cuenta como inanición (1 ms) */
+
+typedef struct {
+    atomic_ullong n;                     /* adquisiciones */
+    atomic_ullong wait_ns, wait_max_ns;  /* hasta obtener el lock */
+    atomic_ullong hold_ns, hold_max_ns;  /* con el lock tomado */
+} lock_prof_t;
+
+typedef struct {
+    _Alignas(64) atomic_int pid;    /* 0 = slot libre */
+    lock_prof_t rd, wr;             /* reader_enter/exit, writer_enter/exit */
+    atomic_ullong seq_retries;      /* SYNC_SEQLOCK: lecturas optimistas repetidas */
+    atomic_ullong starved;          /* esperas de escritor > PROF_STARVE_NS */
+} proc_prof_t;
+
 typedef struct {
     sem_t state_changed;            /* A: máster → vista — hay cambios */
     sem_t state_rendered;           /* B: vista  → máster — terminó de imprimir */
@@ -18,14 +68,30 @@ typedef struct {
     sem_t readers_count_lock;       /* E: mutex del contador de lectores */
     unsigned int readers_count;     /* F: # lectores activos (jugadores/vista) */
     sem_t movement[MAXP];              /* G[i]: permiso a jugador i para 1 movimiento */
+
+    /* ===== extensiones (después de los campos de la cátedra, mismo prefijo) ===== */
+    unsigned int sync_mode;         /* SYNC_RWLOCK / SYNC_SEQLOCK (lo fija el máster) */
+    atomic_uint state_seq;          /* +2 por escritura del máster; seqlock: impar => escribiendo */
+    unsigned int transport;         /* XPORT_PIPE / XPORT_FUTEX (lo fija el máster) */
+    unsigned int view_mode;         /* VIEW_SYNC / VIEW_ASYNC (lo fija el máster) */
+    unsigned int view_fps;          /* VIEW_ASYNC: tope de frames por segundo de la vista */
+    _Alignas(64) atomic_uint doorbell;  /* jugadores → máster: hay respuestas nuevas */
+    atomic_uint master_sleeping;    /* el máster duerme en futex(doorbell) */
+    player_mbox_t mbox[MAXP];       /* buzones de turno (XPORT_FUTEX) */
+    atomic_uint prof_enabled;       /* el máster se compiló con SYNC_PROF */
+    proc_prof_t prof[PROF_SLOTS];   /* perfil de contención por proceso */
 } game_sync_t;
 
 /* ============ API sync (SHM /game_sync) ============ */
 
+/* Nombre del segmento con el namespace del proceso (SHM_SYNC + $CHOMP_SHM_NS). */
+const char *gx_shm_name(char *buf, size_t n);
+
 /* Crea + init semáforos (solo master). Devuelve 0 si ok. */
 int gx_create_and_init(game_sync_t **gx_out);
 
-/* Abre en RW (view y player). Devuelve 0 si ok. */
+/* Abre en RW (view y player). Devuelve 0 si ok. Acepta un segmento con solo los campos de la
+   cátedra: las extensiones quedan en 0 (protocolo original). */
 int gx_open_rw(game_sync_t **gx_out);
 
 /* Cierre/unmap. */
@@ -34,18 +100,85 @@ void gx_close(game_sync_t *gx);
 /* Destruye todos los semáforos (solo master, antes de cerrar). */
 void gx_destroy_sems(game_sync_t *gx);
 
+/* Inicializa semáforos y extensiones sobre memoria ya mapeada (pshared). Devuelve 0 si ok. */
+int gx_init(game_sync_t *gx);
+
 /* ===== Esperas robustas y esquema lectores–escritor ===== */
 int  sem_wait_intr(sem_t *s); /* reintenta si EINTR, devuelve 0 si ok */
 void reader_enter(game_sync_t *gx);
 void reader_exit (game_sync_t *gx);
 void writer_enter(game_sync_t *gx);
 void writer_exit (game_sync_t *gx);
+/* En SYNC_SEQLOCK writer_enter/exit solo mueven state_seq (hay un único escritor). */
+
+/* Asocia el proceso llamador al slot de perfil (PROF_SLOT_*); sin SYNC_PROF no hace nada.
+   Desde ahí sus reader/writer_enter/exit y relecturas de seqlock se cuentan en ese slot. */
+void sync_prof_bind(game_sync_t *gx, int slot);
+
+/* Copia consistente de `bytes` desde el estado compartido `src` a `dst`.
+   RWLOCK: reader_enter + memcpy + reader_exit. SEQLOCK: reintenta hasta leer sin escritura en curso. */
+void sync_read_snapshot(game_sync_t *gx, void *dst, const void *src, size_t bytes);
+
+/* Lectura optimista (solo SYNC_SEQLOCK), para leer una parte del estado sin copiarlo entero:
+   do { s = sync_read_begin(gx); ...leer... } while (sync_read_retry(gx, s)); */
+unsigned sync_read_begin(game_sync_t *gx);
+bool     sync_read_retry(game_sync_t *gx, unsigned seq);
+
+/* Versión del estado (state_seq), sin lock: avanza con cada writer_exit en ambos modos, así que
+   si no cambió desde una lectura, el estado tampoco. Con un máster de la cátedra queda en 0. */
+unsigned sync_state_version(game_sync_t *gx);
+
+/* ===== Pacing del máster: ticks con deadline absoluto =====
+   Cada tick vence en ancla + k·período (clock_nanosleep TIMER_ABSTIME), así el procesamiento
+   y el render quedan dentro del tick en vez de sumarse al delay. Si un tick ya venció al
+   llegar (overrun) no se duerme y el ancla se corre a ahora: no hay ráfagas para recuperar. */
+#define TICK_PER_MOVE  0u   /* un tick por jugada atendida */
+#define TICK_PER_ROUND 1u   /* un tick cuando cada jugador vivo jugó una vez */
+
+typedef struct {
+    long long period_ns;            /* 0 => sin pacing */
+    unsigned mode;                  /* TICK_PER_MOVE / TICK_PER_ROUND */
+    unsigned long long next_ns;     /* próximo deadline (CLOCK_MONOTONIC); 0 = sin anclar */
+    unsigned long ticks, overruns;
+    long long jitter_sum_ns, jitter_max_ns;  /* despertar - deadline, en ticks dormidos */
+    long long overrun_max_ns;                /* atraso del peor overrun */
+    volatile sig_atomic_t *stop;             /* apagado pedido: no dormir (NULL = no mirar) */
+    int wake_fd;                             /* legible => cortar la espera (-1 = ninguno) */
+} tick_sched_t;
+
+void tick_init(tick_sched_t *t, int period_ms, unsigned mode);
+/* Corta la espera del tick si *stop se prende o wake_fd queda legible (p.ej. el signalfd del
+   máster con SIGINT/SIGTERM pendiente). El fd no se lee: la señal la atiende el loop. */
+void tick_bind_stop(tick_sched_t *t, volatile sig_atomic_t *stop, int wake_fd);
+/* Duerme hasta el próximo deadline (el primer llamado ancla el reloj), salvo apagado. */
+void tick_wait(tick_sched_t *t);
 
 /* ===== Máster ↔ Vista + delay ===== */
-void sync_notify_view_and_delay(game_sync_t *gx, bool has_view, int delay_ms,volatile sig_atomic_t *g_stop);
+/* VIEW_SYNC: post state_changed + wait state_rendered. VIEW_ASYNC: solo avisa (sin acumular
+   posts) y no espera: la vista junta los cambios y dibuja el último estado.
+   Después espera el tick (NULL: no espera, p.ej. a mitad de una ronda). */
+void sync_notify_view_and_delay(game_sync_t *gx, bool has_view, tick_sched_t *tick, volatile sig_atomic_t *g_stop);
 
 /* ===== Turnos jugador (G[i]) ===== */
+/* En XPORT_FUTEX operan sobre mbox[i] en lugar de movement[i]. */
 int  sync_allow_one_move(game_sync_t *gx, int i); /* post movement[i] */
 int  sync_wait_my_turn  (game_sync_t *gx, int i); /* wait movement[i] */
+/* Como sync_wait_my_turn pero con límite: 0 = turno, 1 = venció timeout_ms (< 0: sin límite), -1 = error */
+int  sync_wait_my_turn_for(game_sync_t *gx, int i, int timeout_ms);
+
+/* Sello de respuesta (para medir permiso → jugada): el jugador lo marca justo antes de
+   escribir su jugada y el máster lo lee al recibirla. */
+unsigned long long sync_now_ns(void);                         /* CLOCK_MONOTONIC en ns */
+void               sync_stamp_reply(game_sync_t *gx, int i);  /* jugador */
+unsigned long long sync_reply_stamp(game_sync_t *gx, int i);  /* máster */
+
+/* ===== Buzones (XPORT_FUTEX): reemplazan el pipe ===== */
+void     mbox_reply(game_sync_t *gx, int i, unsigned char dir); /* jugador: publica su jugada */
+void     mbox_close(game_sync_t *gx, int i);                     /* jugador: se retira */
+unsigned mbox_pending(game_sync_t *gx, int n);                  /* máster: bit i => buzón i con respuesta/cierre */
+int      mbox_take(game_sync_t *gx, int i, unsigned char *dir);  /* máster: 0 jugada, 1 cerrado (una vez), 2 nada */
+unsigned mbox_doorbell(game_sync_t *gx);                         /* máster: valor actual del timbre */
+/* máster: duerme hasta que el timbre cambie respecto de `seen` o pasen timeout_ms */
+void     mbox_wait_doorbell(game_sync_t *gx, unsigned seen, int timeout_ms);
 
 #endif
\ No newline at end of file
@@ -0,0 +1,48 @@
+#ifndef TERRITORY_H
+#define TERRITORY_H
+
+#pragma once
+#include <stdint.h>
+#include "shared_mem.h"   // gs_cells_t
+
+/* ===== Territorio por flood fill (STRAT_TERRITORY) =====
+   BFS de 8 vecinos sobre las celdas libres de una ventana TERR_SIDE x TERR_SIDE alrededor
+   del jugador: área alcanzable y partición de Voronoi (cada libre es de quien llega primero;
+   empates = disputada). Cola y marcas de visita son por hilo y se reservan una vez: cada BFS
+   avanza una generación en vez de limpiar el arreglo, así que una decisión no reserva ni
+   borra nada y cuesta O(TERR_SIDE²) por BFS aunque el tablero sea de GS_MAX_SIDE de lado.
+   Fuera de la ventana no se mira; un eje de hasta TERR_SIDE celdas entra entero, así que en
+   tableros de hasta TERR_SIDE de lado el resultado es exacto. */
+
+#define TERR_RADIUS 15
+#define TERR_SIDE   (2 * TERR_RADIUS + 1)
+#define TERR_NP     9                 /* fuentes máximas (players[9]) */
+
+/* Libres de la ventana alrededor de (cx,cy), recortada al tablero (lo de afuera cuenta ocupado).
+   Lee las filas cy±TERR_RADIUS, o todas si el tablero tiene hasta TERR_SIDE filas. */
+typedef struct {
+    const gs_cells_t *b;
+    int ox, oy;                       /* esquina superior izquierda en coordenadas del tablero */
+    uint64_t rows[TERR_SIDE + 2];     /* fila oy+r en rows[r+1], columna ox+c en el bit c+1:
+                                         marco de una celda en 0, los vecinos no chequean bordes */
+} terr_win_t;
+
+/* Resultado de terr_voronoi, por fuente. Las celdas de las fuentes no cuentan. */
+typedef struct {
+    unsigned cells[TERR_NP];          /* libres que la fuente alcanza estrictamente primero */
+    unsigned value[TERR_NP];          /* suma de sus recompensas */
+    unsigned contested;               /* libres alcanzadas a la vez por dos o más fuentes */
+} terr_count_t;
+
+/* Carga la ventana (TERR_SIDE extracciones de fila del bitmap). */
+void terr_win_load(terr_win_t *w, const gs_cells_t *b, int cx, int cy);
+
+/* Libres de la ventana alcanzables desde (x,y) sin contar (x,y). */
+unsigned terr_reachable(const terr_win_t *w, int x, int y);
+
+/* Voronoi multi-fuente desde (sx[i],sy[i]), i < n <= TERR_NP; las fuentes fuera de la
+   ventana no participan (quedan en 0). Una fuente puede estar sobre una celda libre
+   (la candidata propia) u ocupada (cabeza de un rival). */
+void terr_voronoi(const terr_win_t *w, const int *sx, const int *sy, int n, terr_count_t *out);
+
+#endif
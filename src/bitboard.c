@@ -0,0 +1,60 @@
+#include "bitboard.h"
+
+/* ===== sumadores bit-sliced ===== */
+
+static inline void full_add(uint64_t a, uint64_t b, uint64_t c, uint64_t *sum, uint64_t *carry){
+    uint64_t t = a ^ b;
+    *sum = t ^ c;
+    *carry = (a & b) | (t & c);
+}
+
+/* Fila y desplazada: bit b de la palabra w pasa a representar la celda de la izquierda/derecha */
+static inline uint64_t word_at(const uint64_t *row, unsigned stride, long w){
+    return (w < 0 || w >= (long)stride) ? 0 : row[w];
+}
+static inline uint64_t from_left(const uint64_t *row, unsigned stride, long w){
+    return (word_at(row, stride, w) << 1) | (word_at(row, stride, w - 1) >> 63);
+}
+static inline uint64_t from_right(const uint64_t *row, unsigned stride, long w){
+    return (word_at(row, stride, w) >> 1) | (word_at(row, stride, w + 1) << 63);
+}
+
+void bb_mobility_rows(const gs_cells_t *c, int y0, int y1, unsigned char *out){
+    unsigned stride = c->stride;
+    for (int y = y0; y < y1; ++y) {
+        const uint64_t *up  = c->bits + (size_t)(y - 1 + GS_BITS_PAD) * stride;
+        const uint64_t *mid = up + stride;
+        const uint64_t *dn  = mid + stride;
+        unsigned char *o = out + (size_t)(y - y0) * c->W;
+
+        for (long w = 0; w < (long)stride; ++w) {
+            // 8 vecinos como vectores de 64 celdas
+            uint64_t s1, c1, s2, c2, s3, c3, ones, c4, t, c5, twos, c6;
+            full_add(up[w], from_left(up, stride, w), from_right(up, stride, w), &s1, &c1);
+            full_add(from_left(mid, stride, w), from_right(mid, stride, w), dn[w], &s2, &c2);
+            full_add(from_left(dn, stride, w), from_right(dn, stride, w), 0, &s3, &c3);
+            full_add(s1, s2, s3, &ones, &c4);          // peso 1
+            full_add(c1, c2, c3, &t, &c5);             // peso 2 (+ acarreo peso 4)
+            twos = t ^ c4; c6 = t & c4;
+            uint64_t fours = c5 ^ c6, eights = c5 & c6;
+
+            // volcar solo los bits que caen dentro del tablero
+            long bx0 = w * 64, x0 = bx0 - GS_BITS_PAD;
+            long lo = x0 < 0 ? -x0 : 0;
+            long hi = (long)c->W - x0; if (hi > 64) hi = 64;
+            for (long b = lo; b < hi; ++b) {
+                o[x0 + b] = (unsigned char)(((ones >> b) & 1u) | ((twos >> b) & 1u) << 1 |
+                                            ((fours >> b) & 1u) << 2 | ((eights >> b) & 1u) << 3);
+            }
+        }
+    }
+}
+
+unsigned int bb_count_free_rows(const gs_cells_t *c, int y0, int y1){
+    unsigned int n = 0;
+    for (int y = y0; y < y1; ++y) {
+        const uint64_t *row = c->bits + (size_t)(y + GS_BITS_PAD) * c->stride;
+        for (unsigned w = 0; w < c->stride; ++w) n += (unsigned)__builtin_popcountll(row[w]);
+    }
+    return n;
+}
@@ -0,0 +1,107 @@
+#define _DEFAULT_SOURCE
+#include "event_loop.h"
+#include <sys/epoll.h>
+#include <sys/timerfd.h>
+#include <sys/signalfd.h>
+#include <unistd.h>
+#include <string.h>
+#include <errno.h>
+#include <stdint.h>
+
+#define EV_MAX_BATCH 32
+
+/* data.u64 = kind << 32 | tag */
+static inline uint64_t ev_pack(ev_kind_t kind, int tag){
+    return ((uint64_t)kind << 32) | (uint32_t)tag;
+}
+
+static int ev_add_raw(int epfd, int fd, uint64_t data){
+    struct epoll_event e;
+    memset(&e, 0, sizeof e);
+    e.events = EPOLLIN;
+    e.data.u64 = data;
+    return epoll_ctl(epfd, EPOLL_CTL_ADD, fd, &e);
+}
+
+int ev_open(ev_loop_t *ev, const sigset_t *sigs, sigset_t *old_mask){
+    if (!ev || !sigs) return -1;
+    ev->epfd = ev->tfd = ev->sfd = -1;
+
+    if (sigprocmask(SIG_BLOCK, sigs, old_mask) == -1) return -1;
+
+    ev->epfd = epoll_create1(EPOLL_CLOEXEC);
+    if (ev->epfd == -1) goto fail;
+    ev->tfd = timerfd_create(CLOCK_MONOTONIC, TFD_CLOEXEC|TFD_NONBLOCK);
+    if (ev->tfd == -1) goto fail;
+    ev->sfd = signalfd(-1, sigs, SFD_CLOEXEC|SFD_NONBLOCK);
+    if (ev->sfd == -1) goto fail;
+
+    if (ev_add_raw(ev->epfd, ev->tfd, ev_pack(EV_TIMER, 0)) == -1) goto fail;
+    if (ev_add_raw(ev->epfd, ev->sfd, ev_pack(EV_SIGNAL, 0)) == -1) goto fail;
+    return 0;
+
+fail:
+    ev_close(ev);
+    return -1;
+}
+
+void ev_close(ev_loop_t *ev){
+    if (!ev) return;
+    if (ev->sfd  >= 0) close(ev->sfd);
+    if (ev->tfd  >= 0) close(ev->tfd);
+    if (ev->epfd >= 0) close(ev->epfd);
+    ev->epfd = ev->tfd = ev->sfd = -1;
+}
+
+int ev_add_fd(ev_loop_t *ev, int fd, int tag){
+    if (!ev || fd < 0 || tag < 0) return -1;
+    return ev_add_raw(ev->epfd, fd, ev_pack(EV_FD, tag));
+}
+
+int ev_del_fd(ev_loop_t *ev, int fd){
+    if (!ev || fd < 0) return -1;
+    return epoll_ctl(ev->epfd, EPOLL_CTL_DEL, fd, NULL);
+}
+
+int ev_set_deadline(ev_loop_t *ev, const struct timespec *abs_deadline){
+    if (!ev || !abs_deadline) return -1;
+    struct itimerspec its;
+    memset(&its, 0, sizeof its);
+    its.it_value = *abs_deadline;
+    /* it_value == 0 desarma el timer: un deadline "en el origen" ya venció */
+    if (its.it_value.tv_sec == 0 && its.it_value.tv_nsec == 0) its.it_value.tv_nsec = 1;
+    return timerfd_settime(ev->tfd, TFD_TIMER_ABSTIME, &its, NULL);
+}
+
+void ev_timer_ack(ev_loop_t *ev){
+    uint64_t expirations;
+    ssize_t r;
+    do { r = read(ev->tfd, &expirations, sizeof expirations); } while (r == -1 && errno == EINTR);
+}
+
+int ev_read_signal(ev_loop_t *ev){
+    struct signalfd_siginfo si;
+    for (;;) {
+        ssize_t r = read(ev->sfd, &si, sizeof si);
+        if (r == (ssize_t)sizeof si) return (int)si.ssi_signo;
+        if (r == -1 && errno == EINTR) continue;
+        if (r == -1 && errno == EAGAIN) return 0;
+        return -1;
+    }
+}
+
+int ev_wait(ev_loop_t *ev, ev_event_t *out, int max, int timeout_ms){
+    if (!ev || !out || max <= 0) return -1;
+    struct epoll_event evs[EV_MAX_BATCH];
+    if (max > EV_MAX_BATCH) max = EV_MAX_BATCH;
+
+    int n;
+    do { n = epoll_wait(ev->epfd, evs, max, timeout_ms); } while (n == -1 && errno == EINTR);
+    if (n <= 0) return n;
+
+    for (int k = 0; k < n; ++k) {
+        out[k].kind = (ev_kind_t)(evs[k].data.u64 >> 32);
+        out[k].tag  = (int)(uint32_t)evs[k].data.u64;
+    }
+    return n;
+}
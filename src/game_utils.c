@@ -5,6 +5,7 @@
 #include <errno.h>
 #include <stdarg.h>
 #include <stdlib.h>
+#include <poll.h>
 
 /*die con exit*/
 void die(const char *fmt, ...){
@@ -30,6 +31,13 @@ void die_fast(const char *fmt, ...){
 const char* base_name(const char *path){
     const char *s = strrchr(path, '/'); return s ? s + 1 : path;
 }
+const char *shm_ns_name(const char *base, char *buf, size_t n){
+    const char *ns = getenv(SHM_NS_ENV);
+    if (!ns || !*ns || strlen(ns) > SHM_NS_MAX || strchr(ns, '/')) ns = "";
+    snprintf(buf, n, "%s%s", base, ns);
+    return buf;
+}
+
 void set_cloexec(int fd, int on){
     int flags = fcntl(fd, F_GETFD);
     if (flags == -1) die("fcntl(F_GETFD): %s", strerror(errno));
@@ -50,7 +58,7 @@ int proto_read_dir(int fd, unsigned char *dir_out){
         else if (r == 0) {return 1;}        // EOF
         else{
             if(errno == EINTR)continue;
-            if (errno == EAGAIN) { usleep(1000); continue; }
+            if (errno == EAGAIN) return 2;  // nada para leer: que el caller vuelva a esperar
         } 
         return -1;                    // error
     }
@@ -63,7 +71,11 @@ int proto_write_dir(int fd, unsigned char dir){
         if (w == 1){ return 0; }       // ok
         else{
             if(errno == EINTR) continue;
-            if (errno == EAGAIN){ usleep(1000); continue; }
+            if (errno == EAGAIN){
+                // pipe lleno (fd no bloqueante): dormir en el kernel hasta que haya lugar
+                struct pollfd pfd = { .fd = fd, .events = POLLOUT };
+                if (poll(&pfd, 1, -1) >= 0 || errno == EINTR) continue;
+            }
         }
         return -1;                    // error
     }
@@ -0,0 +1,51 @@
+#include "lat_hist.h"
+
+/* Bloque 0: valores < HIST_SUB, exactos. Bloque k >= 1: [2^(k+SUB_BITS-1), 2^(k+SUB_BITS))
+   partido en HIST_SUB sub-buckets de igual ancho. */
+static inline unsigned bucket_of(uint64_t v){
+    if (v < HIST_SUB) return (unsigned)v;
+    unsigned e = 63u - (unsigned)__builtin_clzll(v);                  /* >= HIST_SUB_BITS */
+    if (e >= HIST_MAX_EXP) return HIST_BUCKETS - 1u;
+    unsigned sub = (unsigned)(v >> (e - HIST_SUB_BITS)) - HIST_SUB;    /* 0..HIST_SUB-1 */
+    return (e - HIST_SUB_BITS + 1u) * HIST_SUB + sub;
+}
+
+static inline uint64_t bucket_high(unsigned idx){
+    unsigned blk = idx / HIST_SUB, sub = idx % HIST_SUB;
+    if (blk == 0) return sub;
+    unsigned shift = blk - 1u;                                         /* e - HIST_SUB_BITS */
+    return (((uint64_t)(HIST_SUB + sub) + 1u) << shift) - 1u;
+}
+
+void hist_record(lat_hist_t *h, uint64_t ns){
+    if (h->count == 0 || ns < h->min_ns) h->min_ns = ns;
+    if (ns > h->max_ns) h->max_ns = ns;
+    h->count++;
+    h->sum_ns += ns;
+    h->b[bucket_of(ns)]++;
+}
+
+uint64_t hist_percentile(const lat_hist_t *h, double q){
+    if (h->count == 0) return 0;
+    if (q < 0) q = 0;
+    if (q > 1) q = 1;
+    // rango de la muestra buscada (1..count), redondeando hacia arriba
+    uint64_t rank = (uint64_t)(q * (double)h->count);
+    if ((double)rank < q * (double)h->count) rank++;
+    if (rank == 0) rank = 1;
+
+    uint64_t seen = 0;
+    for (unsigned i = 0; i < HIST_BUCKETS; ++i) {
+        seen += h->b[i];
+        if (seen < rank) continue;
+        uint64_t v = bucket_high(i);
+        if (v > h->max_ns) v = h->max_ns;
+        if (v < h->min_ns) v = h->min_ns;
+        return v;
+    }
+    return h->max_ns;
+}
+
+double hist_mean(const lat_hist_t *h){
+    return h->count ? (double)h->sum_ns / (double)h->count : 0.0;
+}
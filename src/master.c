@@ -1,4 +1,4 @@
-#define _DEFAULT_SOURCE
+#define _GNU_SOURCE       // sched_setaffinity (servidor)
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdarg.h>
@@ -11,12 +11,18 @@
 #include <errno.h>
 #include <sys/mman.h>
 #include <sys/stat.h>
-#include <sys/select.h>
 #include <sys/wait.h>
+#include <sched.h>
+#include <sys/prctl.h>
 
 #include "game_utils.h"   // die, base_name, set_cloexec, DX/DY, idx_wh/in_bounds_wh 
 #include "shared_mem.h"   // game_state_t, gs_create_and_init, gs_init_board_rewards, gs_place_players 
 #include "sync_utils.h"   // game_sync_t, gx_create_and_init, writer_enter/exit, sem_wait_intr, notify   
+#include "event_loop.h"   // ev_loop_t: epoll + timerfd + signalfd
+#include "lat_hist.h"     // lat_hist_t: latencias por jugador y fase
+#include "move_log.h"     // mlog_*: log binario de la partida y replay
+#include "stats_sock.h"   // stats_sock_t: estadísticas en vivo por socket Unix
+#include "player_pool.h"  // player_pool_t: jugadores persistentes del servidor (-k)
 
 // --- ANSI colors para A..I, igual que la vista ---
 #define ANSI_RESET   "\x1b[0m"
@@ -38,8 +44,13 @@ static const char *ansi_player_color(int idx) {
 }
 
 // ============= util =============
-static volatile sig_atomic_t g_stop = 0;
-static void on_signal(int sig);
+static volatile sig_atomic_t g_stop = 0;   // lo levanta un EV_SIGNAL del signalfd
+static sigset_t g_orig_sigmask;            // máscara previa, se restaura en los hijos antes del exec
+static sigset_t g_stop_sigs;               // SIGINT/SIGTERM (van al signalfd)
+static bool g_shm_owner = false;           // este proceso creó los segmentos: los borra al salir
+
+// ============= event loop =============
+static ev_loop_t EV = { .epfd = -1, .tfd = -1, .sfd = -1 };
 
 // ============= shm globals =============
 static game_state_t *gs = NULL;
@@ -50,11 +61,29 @@ static size_t GS_BYTES = 0;
 typedef struct {
     int w, h;             // dimensiones del tablero
     int delay_ms;         // ms entre renders / ticks
+    unsigned pacing;      // TICK_PER_MOVE / TICK_PER_ROUND
     int timeout_s;        // cortar por inactividad global
     unsigned int seed;    // semilla para rewards/colocación
     const char *view_path;// binario de vista (NULL => sin vista)
+    int view_fps;         // > 0: vista asíncrona con ese tope de fps (el máster no la espera)
     int nplayers;         // cantidad de jugadores
     const char *pbin[MAXP]; // rutas a binarios de jugadores
+    bool batch;           // atender todos los jugadores listos por wakeup
+    unsigned sync_mode;   // SYNC_RWLOCK / SYNC_SEQLOCK
+    unsigned transport;   // XPORT_PIPE / XPORT_FUTEX
+    bool hugepages;       // /game_state con MADV_HUGEPAGE
+    bool compact;         // espejo compacto del board (1 byte/celda + bitmap)
+    bool gap_log;         // una línea por jugada con el tiempo permiso → respuesta
+    const char *lat_json; // archivo JSON con los percentiles por jugador y fase (NULL => no)
+    const char *record_path; // -R: log binario de las jugadas aplicadas
+    const char *replay_path; // -r: reproduce un log en vez de lanzar jugadores
+    const char *stats_path;  // -u: socket Unix con estadísticas en vivo
+    const char *shm_ns;   // -N: namespace de /game_state y /game_sync (ver SHM_NS_ENV)
+    int games;            // -S: modo servidor, cantidad de partidas (0 => una partida normal)
+    int jobs;             // -J: partidas simultáneas del servidor (default: núcleos online)
+    bool quiet;           // partida del servidor: sin config ni resultados por stderr
+    bool keep_players;    // -k: el servidor reusa jugadores persistentes (pool) entre partidas
+    int pool_group;       // partida con pool: grupo de slots a usar (-1 => lanzar jugadores)
 } opts_t;
 
 static void parse_opts(int argc, char **argv, opts_t *o);
@@ -77,146 +106,296 @@ static void cleanup(void);
 // Drena lo que quede en los pipes de jugadores y espera a que cierren (EOF).
 // Mantiene los read-end abiertos para evitar SIGPIPE en los hijos.
 static void drain_players_until_exit(int nplayers, int grace_ms);
+// Desregistra del epoll y cierra el read-end del jugador i.
+static void close_player_pipe(int i);
+
+// ============= espera de jugadores =============
+// Bloquea hasta que algún jugador tenga algo para leer (jugada o cierre). Devuelve el bitmask
+// de listos; deja *timer=true si venció el deadline y levanta g_stop ante una señal.
+static unsigned wait_ready(const opts_t *o, bool *timer);
+// Revisa el epoll (pipes, timerfd, signalfd) hasta timeout_ms. Devuelve los pipes listos.
+static unsigned poll_events(int timeout_ms, bool *timer);
+// Toma la jugada pendiente del jugador i (pipe o buzón): 0 jugada, 1 EOF/cierre, 2 nada, -1 error.
+static int take_move(const opts_t *o, int i, unsigned char *dir);
+
+// ============= timeout de inactividad =============
+// Arma el timerfd en last_valid + timeout_s (deadline absoluto).
+static void arm_inactivity_deadline(const struct timespec *last_valid, int timeout_s);
+// ¿Pasaron timeout_s desde el último movimiento válido?
+static bool inactivity_expired(const struct timespec *last_valid, int timeout_s);
 
 // ============= spawn helpers =============
 static void spawn_view(const opts_t *o);
 static void spawn_players(const opts_t *o, int pipes[][2]);
 
+// ============= pacing =============
+static tick_sched_t TICK;
+static int g_round_served = 0;   // jugadas atendidas en la ronda actual (TICK_PER_ROUND)
+// Tick a esperar tras atender `served` jugadas: por jugada siempre; por ronda solo cuando
+// cada jugador vivo jugó una vez. NULL si todavía no toca.
+static tick_sched_t *tick_after(int served);
+
+// ============= latencia por jugada y fase =============
+// Cada jugada atendida se parte en fases y cada fase se suma al histograma del jugador:
+//   post      sync_allow_one_move (sem_post / futex wake)
+//   reply     permiso → el jugador escribe (lo sella en mbox[i].replied_ns)
+//   ready     jugada escrita → el máster la toma (epoll/timbre + cola RR)
+//   read      proto_read_dir / mbox_take
+//   lock_wait writer_enter de la jugada
+//   lock_hold gs_apply_move bajo el lock de escritor
+//   mark      gs_mark_blocked_players
+//   view      ida y vuelta con la vista (sin el tick)
+enum { PH_POST, PH_REPLY, PH_READY, PH_READ, PH_LOCK_WAIT, PH_LOCK_HOLD, PH_MARK, PH_VIEW, PH_COUNT };
+static const char *const PH_NAME[PH_COUNT] = {
+    "post", "reply", "ready", "read", "lock_wait", "lock_hold", "mark", "view"
+};
+static lat_hist_t LAT[MAXP][PH_COUNT];
+
+typedef struct {
+    unsigned long long granted_ns; // último permiso otorgado (CLOCK_MONOTONIC)
+    bool pending;             // permiso sin respuesta todavía
+    unsigned long n;          // jugadas medidas
+} turn_gap_t;
+static turn_gap_t GAP[MAXP];
+
+// sync_allow_one_move + marca de tiempo para medir la respuesta (die si falla).
+static void grant_turn(int i);
+// Toma la jugada del jugador i midiendo la lectura; si es una jugada (0) cierra la medición
+// permiso → respuesta → toma (-g: imprime la respuesta). Mismos códigos que take_move.
+static int take_move_timed(const opts_t *o, int i, unsigned char *dir);
+// Suma ns a la fase ph de los n jugadores de who.
+static void lat_add(const int *who, int n, int ph, unsigned long long ns);
+// Avisa a la vista midiendo la ida y vuelta para los jugadores atendidos y espera el tick.
+static void publish_frame(const int *who, int n);
+// Percentiles por fase del jugador i (una línea) y, con -j, el JSON de todos.
+static void print_latency(int i);
+static void write_latency_json(const char *path, int nplayers);
+
+// ============= log binario / replay =============
+static mlog_writer_t MLOG = { .fd = -1 };
+static mlog_reader_t RLOG;
+// Abre el log de -r y toma de su encabezado dimensiones, jugadores, semilla y flags.
+static void load_replay(opts_t *o);
+// Encabezado con la configuración de la partida y apertura del log de -R.
+static void open_record(const opts_t *o, unsigned gs_flags);
+// Cierra el log de -R con los resultados finales.
+static void close_record(const opts_t *o);
+// Reaplica los eventos del log sobre /game_state (sin jugadores), con la vista y el pacing
+// de siempre. Devuelve el exit status: 0 si los resultados coinciden con los grabados.
+static int replay_game(const opts_t *o);
+
+// ============= estadísticas en vivo (-u) =============
+// El socket se registra en el epoll con este tag (los jugadores usan 0..MAXP-1)
+#define STATS_TAG       MAXP
+#define STATS_PERIOD_MS 100
+static stats_sock_t SS = { .lfd = -1 };
+// Con clientes conectados y cada STATS_PERIOD_MS (o siempre si final), manda una línea JSON
+// por cliente con puntaje, jugadas, jugadas/s, celdas libres, bloqueo y tiempo por jugada.
+// Lee los contadores sin lock: el máster es el único escritor del estado.
+static void stats_publish(const opts_t *o, bool final);
+
+// Espera a la vista e informa cómo terminó.
+static void wait_view(void);
+
+// ============= partidas =============
+// Una partida completa (crear shm, lanzar vista/jugadores, loop, resultados). Exit status.
+static int run_game(const opts_t *o);
+
+// Deja el proceso como antes de run_game: borra los segmentos de la partida y cierra sus pipes.
+static void end_game(void);
+
+// Modo servidor (-S): o->games partidas, hasta o->jobs a la vez. Cada cupo es un worker
+// persistente (fork una vez, sin exec) fijado a un núcleo (round-robin) que juega las partidas
+// que le manda el padre por su pipe de trabajos, cada una con su propio namespace de shm;
+// sus jugadores heredan ambos. El padre junta los resultados por un pipe.
+typedef struct {
+    int game;
+    int group;            // cupo que la jugó
+    unsigned seed;
+    int nplayers;
+    unsigned score[MAXP], valid[MAXP], invalid[MAXP];
+    double ms;
+} game_result_t;
+static int serve_games(const opts_t *o);
+
+// Pool (-k): jobs grupos de nplayers slots; el grupo g lo usa la partida que corre en el
+// cupo g. El servidor crea el segmento y lanza los jugadores una vez (su stdout es un pipe
+// que solo sirve para detectar si mueren); las partidas heredan el mapeo y los read-end.
+static player_pool_t *POOL = NULL;
+static size_t POOL_BYTES = 0;
+static int *POOL_FD = NULL;                // read-end del stdout de cada slot
+static char g_pool_name[64] = "";          // != "" => este proceso borra el segmento al salir
+static unsigned POOL_SEQ[MAXP];            // aviso de la partida actual por jugador
+// Lanza (o relanza) el jugador persistente del slot k.
+static void spawn_pool_player(const opts_t *o, int k);
+// Partida: asigna los jugadores del grupo o->pool_group y les avisa la partida nueva.
+static void attach_pool_players(const opts_t *o);
+// Partida: espera que cada jugador del pool suelte el estado (hasta grace_ms en total).
+static void release_pool_players(const opts_t *o, int grace_ms);
+
 // ============= procesamiento de un movimiento =============
-static void apply_move_rr(int i, unsigned char dir, int W, int H, int *b, struct timespec *last_valid);
+static void apply_move_rr(int i, unsigned char dir, struct timespec *last_valid);
+// Modo batch: drena todos los pipes listos en orden RR y aplica sus jugadas con un único writer_enter.
+// Devuelve el último jugador atendido (-1 si ninguno) y deja en *can_move si alguien puede seguir.
+static int serve_ready_batch(unsigned ready, const opts_t *o, int rr,
+                             struct timespec *last_valid, bool *can_move);
 
 
 
 // ============= main =============
 int main(int argc, char **argv){
-    // 1) señales / cleanup
-    signal(SIGINT,  on_signal);
-    signal(SIGTERM, on_signal);
+    // 1) señales (via signalfd del event loop) / cleanup
+    sigemptyset(&g_stop_sigs);
+    sigaddset(&g_stop_sigs, SIGINT);
+    sigaddset(&g_stop_sigs, SIGTERM);
+    if (ev_open(&EV, &g_stop_sigs, &g_orig_sigmask) != 0) die("ev_open: %s", strerror(errno));
     atexit(cleanup);  //limpiar al terminar el proceso
 
     // 2) parsear
     opts_t O; parse_opts(argc, argv, &O);
+    if (O.shm_ns) setenv(SHM_NS_ENV, O.shm_ns, 1); // lo heredan vista y jugadores
+    if (O.games > 0) return serve_games(&O);
+    if (O.replay_path) load_replay(&O);
     print_config(&O);
+    if (O.stats_path) {
+        if (ss_open(&SS, O.stats_path) != 0) die("-u %s: %s", O.stats_path, strerror(errno));
+        if (ev_add_fd(&EV, SS.lfd, STATS_TAG) != 0) die("epoll_ctl(stats): %s", strerror(errno));
+    }
+    return run_game(&O);
+}
 
+// ============= una partida =============
+static int run_game(const opts_t *o){
     // 3-4) crear memorias compartidas
-    if (gs_create_and_init(O.w, O.h, (unsigned)O.nplayers, &gs, &GS_BYTES) != 0) // ancho, alto, cantidad jugadores, salida **gs y *bytes
-        die("gs_create_and_init"); 
+    unsigned gs_flags = (o->hugepages ? GS_F_HUGEPAGES : 0) | (o->compact ? GS_F_COMPACT : 0);
+    if (gs_create_and_init(o->w, o->h, (unsigned)o->nplayers, gs_flags, &gs, &GS_BYTES) != 0) // ancho, alto, cantidad jugadores, flags, salida **gs y *bytes
+        die("gs_create_and_init(%dx%d): %s", o->w, o->h, strerror(errno)); 
     if (gx_create_and_init(&gx) != 0)
         die("gx_create_and_init");
+    g_shm_owner = true;
+    sync_prof_bind(gx, PROF_SLOT_MASTER); // build PROF=1: perfil de contención en /game_sync
+    gx->sync_mode = o->sync_mode; // antes de lanzar hijos: lo leen al conectarse
+    gx->transport = o->transport;
+    gx->view_mode = o->view_fps > 0 ? VIEW_ASYNC : VIEW_SYNC;
+    gx->view_fps = (unsigned)o->view_fps;
 
     // 5) inicializar tablero y jugadores
-    gs_init_board_rewards(gs->board, O.w, O.h, O.seed);
+    gs_init_board_rewards(gs->board, o->w, o->h, o->seed);
     if (gs_place_players(gs) != 0) die("gs_place_players"); //ubica jugadores en celdas válidas, limpia contadores
+    if (o->replay_path) return replay_game(o);
 
     
     // 6) lanzar vista y jugadores
-    spawn_view(&O);
+    spawn_view(o);
     int pipes[MAXP][2]; 
     memset(pipes, -1, sizeof(pipes));
-    P.nplayers = O.nplayers; 
+    P.nplayers = o->nplayers; 
     for(int i=0;i<P.nplayers;i++){
         P.pipes_r[i] = -1;
     }
-    spawn_players(&O, pipes);
-    
+    if (o->pool_group >= 0) attach_pool_players(o);
+    else spawn_players(o, pipes);
+    if (o->record_path) open_record(o, gs_flags);
 
    // 7) primer render + habilitar 1 solicitud a cada jugador
-    sync_notify_view_and_delay(gx, g_has_view, O.delay_ms, &g_stop);
+    tick_init(&TICK, o->delay_ms, o->pacing);
+    tick_bind_stop(&TICK, &g_stop, EV.sfd);
+    sync_notify_view_and_delay(gx, g_has_view, &TICK, &g_stop);
     writer_enter(gx);
     gs_mark_blocked_players(gs);
     writer_exit(gx);
+    mlog_put(&MLOG, MLOG_FRAME, 1);
 
-    for (int i = 0; i < O.nplayers; i++) {
+    for (int i = 0; i < o->nplayers; i++) {
         bool blk;
         reader_enter(gx);
         blk = gs->players[i].blocked;
         reader_exit(gx);
 
         // No habilitar bloqueados
-        if (!blk) {
-            if (sync_allow_one_move(gx, i) == -1) { //activa el semaforo para permitir un movimeinto
-                die("sync_allow_one_move(%d): %s", i, strerror(errno));
-            }
-        }
+        if (!blk) grant_turn(i); //activa el semaforo para permitir un movimiento
     }
     
 
-    // 8) loop principal (RR con select)
+    // 8) loop principal (RR con epoll; timeout por timerfd, señales por signalfd)
     struct timespec last_valid; 
     clock_gettime(CLOCK_MONOTONIC, &last_valid);
+    arm_inactivity_deadline(&last_valid, o->timeout_s);
 
     int rr = 0; // round-robin cursor
     while (!g_stop) {
-        // a) calcula cuánto falta para que se pase el timeout
-        struct timespec now; 
-        clock_gettime(CLOCK_MONOTONIC, &now);
-        long long elapsed_ms = (now.tv_sec - last_valid.tv_sec)*1000LL + (now.tv_nsec - last_valid.tv_nsec)/1000000LL;
-        long long remaining_ms = (long long)O.timeout_s*1000LL - elapsed_ms;
-        if (remaining_ms <= 0) break;
-
-        // b) armar fd_set y hacer select
-        fd_set rfds; FD_ZERO(&rfds);
-        int maxfd = -1, alive = 0;
-        for (int i=0;i<O.nplayers;i++){
-            if (P.pipes_r[i] >= 0) {
-                FD_SET(P.pipes_r[i], &rfds);
-                if (P.pipes_r[i] > maxfd) maxfd = P.pipes_r[i];
-                alive++;
-            }
-        }
-        if (alive == 0) break; // no queda nadie escribiendo
-
-        struct timeval tv;
-        tv.tv_sec = (remaining_ms/1000);
-        tv.tv_usec = (remaining_ms%1000)*1000;
-        int rv = select(maxfd+1, &rfds, NULL, NULL, &tv);
-        if (rv < 0) {
-            if (errno == EINTR) continue;
-            die("select: %s", strerror(errno));
+        // a) nadie escribiendo => fin
+        int alive = 0;
+        for (int i=0;i<o->nplayers;i++) if (P.pipes_r[i] >= 0) alive++;
+        if (alive == 0) break;
+
+        // b) esperar jugadores listos (pipes por epoll o buzones por futex)
+        bool timer = false;
+        unsigned ready = wait_ready(o, &timer); // bit i => jugador i tiene algo para leer
+        if (g_stop) break;
+
+        // c) venció el deadline: si hubo movimientos válidos desde que se armó, correrlo
+        if (timer) {
+            ev_timer_ack(&EV);
+            if (inactivity_expired(&last_valid, o->timeout_s)) break; // se corta por inactividad
+            arm_inactivity_deadline(&last_valid, o->timeout_s);
         }
-        if (rv == 0) {
-            // se venció el tv => se corta por inactividad
-            break;
+        if (!ready) continue;
+
+        // d) modo batch: todos los listos en una pasada, un solo lock y un solo render
+        if (o->batch) {
+            bool can_move = true;
+            int last = serve_ready_batch(ready, o, rr, &last_valid, &can_move);
+            if (last >= 0) rr = (last + 1) % o->nplayers;
+            stats_publish(o, false);
+            if (!can_move) break;
+            continue;
         }
 
-        // c) atender SOLO 1 jugador por iteración
+        // d) atender SOLO 1 jugador por iteración
         int processed = -1;
-        for (int off=0; off<O.nplayers; ++off) {
-            int i = (rr + off) % O.nplayers;
+        for (int off=0; off<o->nplayers; ++off) {
+            int i = (rr + off) % o->nplayers;
             if (P.pipes_r[i] < 0) continue;
-            if (!FD_ISSET(P.pipes_r[i], &rfds)) continue;
+            if (!(ready & (1u << i))) continue;
 
             unsigned char dir;
-            int pr = proto_read_dir(P.pipes_r[i], &dir);
+            int pr = take_move_timed(o, i, &dir);
+            if (pr == 2) continue; // wakeup espurio, nada para leer
             if (pr == 0) {
-                apply_move_rr(i, dir, O.w, O.h, gs->board, &last_valid); // aplica el movimiento
+                apply_move_rr(i, dir, &last_valid); // aplica el movimiento
+                mlog_put(&MLOG, (unsigned)i, dir);
                 // si el movimiento encerró a alguien, marcarlo como "blk"
                 writer_enter(gx);
+                unsigned long long t0 = sync_now_ns();
                 gs_mark_blocked_players(gs);
+                lat_add(&i, 1, PH_MARK, sync_now_ns() - t0);
                 writer_exit(gx);
+                mlog_put(&MLOG, MLOG_FRAME, 1);
 
-                sync_notify_view_and_delay(gx, g_has_view, O.delay_ms, &g_stop);
+                publish_frame(&i, 1);
                 // habilitar nueva solicitud a ese jugador
-                if (sync_allow_one_move(gx, i) == -1) die("sync_allow_one_move(%d): %s", i, strerror(errno));
+                grant_turn(i);
             } else if (pr == 1) {
                 // EOF, jugador bloqueado
                 writer_enter(gx);
                 gs->players[i].blocked = true;
                 writer_exit(gx);
-                close(P.pipes_r[i]); //cierra FD
-                P.pipes_r[i] = -1;
-                sync_notify_view_and_delay(gx, g_has_view, O.delay_ms, &g_stop);
+                mlog_put(&MLOG, MLOG_QUIT | (unsigned)i, 0);
+                mlog_put(&MLOG, MLOG_FRAME, 0);
+                close_player_pipe(i);
+                sync_notify_view_and_delay(gx, g_has_view, tick_after(1), &g_stop);
             } else {
                 // error de lectura => cerrar FD
-                close(P.pipes_r[i]);
-                P.pipes_r[i] = -1;
+                close_player_pipe(i);
             }
             processed = i;
             break;
         }
-        if (processed >= 0) rr = (processed + 1) % O.nplayers;
+        if (processed >= 0) rr = (processed + 1) % o->nplayers;
+        stats_publish(o, false);
 
-        // d) si estan todos bloqueados, termina
+        // e) si estan todos bloqueados, termina
         reader_enter(gx);
         bool can_move = gs_any_player_can_move(gs);
         reader_exit(gx);
@@ -226,29 +405,26 @@ int main(int argc, char **argv){
     writer_enter(gx);
     gs->finished = true;
     writer_exit(gx);
-    sync_notify_view_and_delay(gx, g_has_view, O.delay_ms, &g_stop);
+    if (o->record_path) close_record(o);
+    stats_publish(o, true);
+    sync_notify_view_and_delay(gx, g_has_view, NULL, &g_stop);
 
     // despertar jugadores para que vean que finalizo y salgan
-    for (int i = 0; i < O.nplayers; ++i){
+    for (int i = 0; i < o->nplayers; ++i){
         sync_allow_one_move(gx, i);
     }
 
     // 10) sacar lo que queda y recién después cerrar los FDs (espera 2000 ms para que cierren los jugadores)
-    drain_players_until_exit(O.nplayers, 2000);
+    if (o->pool_group >= 0) release_pool_players(o, 2000);
+    else drain_players_until_exit(o->nplayers, 2000);
     
     // 11) esperar hijos e imprimir resultados
     int status;
-    if (P.view_pid > 0) {
-        if (waitpid(P.view_pid, &status, 0) > 0) {
-            if (WIFEXITED(status))
-                fprintf(stderr, "View exited (%d)\n", WEXITSTATUS(status));
-            else if (WIFSIGNALED(status))
-                fprintf(stderr, "View killed by signal (%d)\n", WTERMSIG(status));
-        }
-    }
-    for (int i = 0; i < O.nplayers; ++i) {
-        if (gs->players[i].pid <= 0) continue;
+    wait_view();
+    for (int i = 0; i < o->nplayers; ++i) {
+        if (gs->players[i].pid <= 0 || o->pool_group >= 0) continue; // los del pool siguen vivos
         if (waitpid(gs->players[i].pid, &status, 0) <= 0) continue;
+        if (o->quiet) continue;
 
         const char *c1 = "", *c0 = "";
         if (isatty(STDERR_FILENO)) { 
@@ -271,43 +447,124 @@ int main(int argc, char **argv){
                     c1, letter, c1, gs->players[i].name, c0, i, c0,
                     WTERMSIG(status), s, v, iv);
         }
+        print_latency(i);
+    }
+    if (o->lat_json) write_latency_json(o->lat_json, o->nplayers);
+    if (TICK.ticks > 0 && !o->quiet) {
+        unsigned long slept = TICK.ticks - TICK.overruns;
+        fprintf(stderr, "Ticks (%s, %d ms): %lu, jitter media %.1f us máx %.1f us, overruns %lu (máx %.1f us)\n",
+                TICK.mode == TICK_PER_ROUND ? "round" : "move", o->delay_ms, TICK.ticks,
+                slept ? (double)TICK.jitter_sum_ns / 1e3 / (double)slept : 0.0, (double)TICK.jitter_max_ns / 1e3,
+                TICK.overruns, (double)TICK.overrun_max_ns / 1e3);
     }
+    return 0;
 }
 
 
 // ============= funciones auxiliares =============
-static void on_signal(int sig){ (void)sig; g_stop = 1; }
-
 static void parse_opts(int argc, char **argv, opts_t *o){
     o->w = 10; o->h = 10;
     o->delay_ms = 200;
+    o->pacing = TICK_PER_MOVE;
     o->timeout_s = 10;
     o->seed = (unsigned)time(NULL);
     o->view_path = NULL;
+    o->view_fps = 0;
     o->nplayers = 0;
+    o->batch = false;
+    o->sync_mode = SYNC_RWLOCK;
+    o->transport = XPORT_PIPE;
+    o->hugepages = false;
+    o->compact = false;
+    o->gap_log = false;
+    o->lat_json = NULL;
+    o->record_path = NULL;
+    o->replay_path = NULL;
+    o->stats_path = NULL;
+    o->shm_ns = NULL;
+    o->games = 0;
+    o->jobs = 0;
+    o->quiet = false;
+    o->keep_players = false;
+    o->pool_group = -1;
 
     int opt;
-    while ((opt = getopt(argc, argv, "w:h:d:t:s:v:p:")) != -1) {
+    while ((opt = getopt(argc, argv, "w:h:d:P:t:s:v:a:bL:T:Hcgj:R:r:u:N:S:J:kp:")) != -1) {
         switch (opt) {
         case 'w': o->w = atoi(optarg); break;
         case 'h': o->h = atoi(optarg); break;
         case 'd': o->delay_ms = atoi(optarg); break;
+        case 'P':
+            if (strcmp(optarg, "move") == 0) o->pacing = TICK_PER_MOVE;
+            else if (strcmp(optarg, "round") == 0) o->pacing = TICK_PER_ROUND;
+            else die("-P: pacing desconocido '%s' (move|round)", optarg);
+            break;
         case 't': o->timeout_s = atoi(optarg); break;
         case 's': o->seed = (unsigned)strtoul(optarg, NULL, 10); break;
         case 'v': o->view_path = optarg; break;
+        case 'a':
+            o->view_fps = atoi(optarg);
+            if (o->view_fps <= 0 || o->view_fps > 1000) die("-a: fps entre 1 y 1000");
+            break;
+        case 'b': o->batch = true; break;
+        case 'H': o->hugepages = true; break;
+        case 'c': o->compact = true; break;
+        case 'g': o->gap_log = true; break;
+        case 'j': o->lat_json = optarg; break;
+        case 'R': o->record_path = optarg; break;
+        case 'r': o->replay_path = optarg; break;
+        case 'u': o->stats_path = optarg; break;
+        case 'N':
+            if (strlen(optarg) > SHM_NS_MAX || strchr(optarg, '/')) die("-N: namespace inválido (sin '/', hasta %d chars)", SHM_NS_MAX);
+            o->shm_ns = optarg;
+            break;
+        case 'S':
+            o->games = atoi(optarg);
+            if (o->games <= 0) die("-S: cantidad de partidas > 0");
+            break;
+        case 'J':
+            o->jobs = atoi(optarg);
+            if (o->jobs <= 0 || o->jobs > 1024) die("-J: partidas simultáneas entre 1 y 1024");
+            break;
+        case 'k': o->keep_players = true; break;
+        case 'L':
+            if (strcmp(optarg, "rw") == 0) o->sync_mode = SYNC_RWLOCK;
+            else if (strcmp(optarg, "seq") == 0) o->sync_mode = SYNC_SEQLOCK;
+            else die("-L: modo desconocido '%s' (rw|seq)", optarg);
+            break;
+        case 'T':
+            if (strcmp(optarg, "pipe") == 0) o->transport = XPORT_PIPE;
+            else if (strcmp(optarg, "futex") == 0) o->transport = XPORT_FUTEX;
+            else die("-T: transporte desconocido '%s' (pipe|futex)", optarg);
+            break;
         case 'p':
-            // -p player1 player2 ...
+            // -p player1 player2 ...; -p puede repetirse
+            if (o->nplayers >= MAXP) die("Demasiados jugadores (max 9)");
             o->pbin[o->nplayers++] = optarg;
             while (optind < argc && argv[optind][0] != '-') {
                 if (o->nplayers >= MAXP) die("Demasiados jugadores (max 9)");
                 o->pbin[o->nplayers++] = argv[optind++];
             }
             break;
-        default: die("Uso: master [-w W] [-h H] [-d delay_ms] [-t timeout_s] [-s seed] [-v view] -p player1 [player2 ...]");
+        default: die("Uso: master [-w W] [-h H] [-d delay_ms] [-P move|round] [-t timeout_s] [-s seed] [-v view] [-a fps] [-b] [-L rw|seq] [-T pipe|futex] [-H] [-c] [-g] [-j latency.json] [-R game.log] [-u stats.sock] [-N ns] [-S games [-J jobs] [-k]] -p player1 [player2 ...] | master -r game.log [-d delay_ms] [-v view] ...");
         }
     }
     if (o->w < 10) o->w = 10;
     if (o->h < 10) o->h = 10;
+    if (o->w > GS_MAX_SIDE || o->h > GS_MAX_SIDE || (size_t)o->w * (size_t)o->h > GS_MAX_CELLS)
+        die("Tablero demasiado grande (lado <= %d, celdas <= %u)", GS_MAX_SIDE, GS_MAX_CELLS);
+    if (o->replay_path) {
+        if (o->nplayers > 0 || o->record_path) die("-r: el replay no lanza jugadores ni graba (-p/-R)");
+        return; // dimensiones, jugadores y semilla salen del log
+    }
+    if (o->games > 0 && (o->view_path || o->record_path || o->stats_path || o->lat_json))
+        die("-S: el servidor no admite -v/-R/-u/-j (son por partida)");
+    if (o->keep_players) {
+        if (o->games == 0) die("-k: solo en modo servidor (-S)");
+        // un jugador persistente no puede cerrar su stdout al retirarse: se retira por buzón
+        o->transport = XPORT_FUTEX;
+    }
+    if (o->seed == 0) o->seed = (unsigned)time(NULL); // la semilla efectiva queda en el log
     if (o->nplayers < 1) die("Error: At least one player must be specified using -p.");
 }
 
@@ -315,9 +572,19 @@ static void print_config(const opts_t *o){
     printf("width: %d\n",   o->w);
     printf("height: %d\n",  o->h);
     printf("delay: %d\n",   o->delay_ms);
+    printf("pacing: %s\n",  o->pacing == TICK_PER_ROUND ? "round" : "move");
     printf("timeout: %d\n", o->timeout_s);
     printf("seed: %u\n",    o->seed);
     printf("view: %s\n",    o->view_path ? o->view_path : "-");
+    if (o->view_fps > 0) printf("view sync: async (%d fps)\n", o->view_fps);
+    printf("batch: %s\n",   o->batch ? "on" : "off");
+    printf("sync: %s\n",    o->sync_mode == SYNC_SEQLOCK ? "seq" : "rw");
+    printf("transport: %s\n", o->transport == XPORT_FUTEX ? "futex" : "pipe");
+    printf("hugepages: %s\n", o->hugepages ? "on" : "off");
+    printf("board: %s\n", o->compact ? "int + compact" : "int");
+    if (o->record_path) printf("record: %s\n", o->record_path);
+    if (o->replay_path) printf("replay: %s (%zu eventos)\n", o->replay_path, RLOG.nrec);
+    if (o->stats_path) printf("stats: %s\n", o->stats_path);
     printf("num_players: %d\n", o->nplayers);
     for (int i = 0; i < o->nplayers; ++i)
         printf("  %s\n", o->pbin[i]);
@@ -331,19 +598,33 @@ static void print_config(const opts_t *o){
 }
 
 // ============= cleanup =============
-static void cleanup(void){
+static void end_game(void){
     if (gs) {
         gx_destroy_sems(gx);   // destruye todos los semáforos G/A/B/C/D/E   
         gs_close(gs, GS_BYTES); // munmap estado                           
         gx_close(gx);           // munmap sync                               
         gs = NULL; gx = NULL;
     }
-    shm_unlink(SHM_STATE);
-    shm_unlink(SHM_SYNC);
-
-    for (int i=0; i<P.nplayers; i++){
-        if (P.pipes_r[i] >= 0) close(P.pipes_r[i]);
+    if (g_shm_owner) {
+        char name[64];
+        shm_unlink(gs_shm_name(name, sizeof name));
+        shm_unlink(gx_shm_name(name, sizeof name));
+        g_shm_owner = false;
     }
+    for (int i = 0; i < P.nplayers; i++) close_player_pipe(i);
+    P.view_pid = -1;
+    g_has_view = false;
+    // métricas por partida: el worker del servidor juega varias en el mismo proceso
+    memset(LAT, 0, sizeof LAT);
+    memset(GAP, 0, sizeof GAP);
+    g_round_served = 0;
+}
+
+static void cleanup(void){
+    end_game();
+    if (g_pool_name[0]) shm_unlink(g_pool_name);
+    ss_close(&SS);
+    ev_close(&EV);
 }
 
 static void drain_players_until_exit(int nplayers, int grace_ms) {
@@ -360,27 +641,18 @@ static void drain_players_until_exit(int nplayers, int grace_ms) {
                             (now.tv_nsec - start.tv_nsec)/1000000LL;
         if (elapsed > grace_ms && grace_ms >= 0) break;
 
-        fd_set rfds; FD_ZERO(&rfds);
-        int maxfd = -1;
-        for (int i = 0; i < nplayers; ++i) {
-            if (P.pipes_r[i] >= 0) {
-                FD_SET(P.pipes_r[i], &rfds);
-                if (P.pipes_r[i] > maxfd) maxfd = P.pipes_r[i];
-            }
-        }
-        if (maxfd < 0) break;
+        int wait_ms = grace_ms >= 0 ? (int)(grace_ms - elapsed) : -1;
+        ev_event_t evs[MAXP + 2];
+        int nev = ev_wait(&EV, evs, MAXP + 2, wait_ms);
+        if (nev < 0) break;
+        if (nev == 0) continue;
 
-        struct timeval tv = { .tv_sec = 0, .tv_usec = 100*1000 }; // 100 ms
-        int rv = select(maxfd + 1, &rfds, NULL, NULL, &tv);
-        if (rv < 0) {
-            if (errno == EINTR) continue;
-            break;
-        }
-        if (rv == 0) continue;
-
-        for (int i = 0; i < nplayers; ++i) {
+        for (int k = 0; k < nev; ++k) {
+            if (evs[k].kind == EV_TIMER) { ev_timer_ack(&EV); continue; }
+            if (evs[k].kind == EV_SIGNAL) { (void)ev_read_signal(&EV); continue; }
+            if (evs[k].tag == STATS_TAG) { (void)ss_accept(&SS); continue; }
+            int i = evs[k].tag;
             if (P.pipes_r[i] < 0) continue;
-            if (!FD_ISSET(P.pipes_r[i], &rfds)) continue;
 
             unsigned char dummy;
             ssize_t r = read(P.pipes_r[i], &dummy, 1);
@@ -389,12 +661,10 @@ static void drain_players_until_exit(int nplayers, int grace_ms) {
                 writer_enter(gx);
                 gs->players[i].blocked = true;
                 writer_exit(gx);
-                close(P.pipes_r[i]);
-                P.pipes_r[i] = -1;
+                close_player_pipe(i);
                 abiertos--;
             } else if (r < 0 && errno != EINTR && errno != EAGAIN) {
-                close(P.pipes_r[i]);
-                P.pipes_r[i] = -1;
+                close_player_pipe(i);
                 abiertos--;
             }
             // si r==1, descarta el byte (llegó justo antes de ver "finished")
@@ -402,6 +672,76 @@ static void drain_players_until_exit(int nplayers, int grace_ms) {
     }
 }
 
+static void close_player_pipe(int i) {
+    if (P.pipes_r[i] < 0) return;
+    ev_del_fd(&EV, P.pipes_r[i]);
+    close(P.pipes_r[i]);
+    P.pipes_r[i] = -1;
+}
+
+// ============= espera de jugadores =============
+// En XPORT_FUTEX se duerme en el timbre de a ratos para revisar señales/EOF/timer
+#define FUTEX_SLICE_MS 50
+
+static unsigned wait_ready(const opts_t *o, bool *timer) {
+    if (o->transport != XPORT_FUTEX) return poll_events(-1, timer);
+
+    static unsigned polls = 0;
+    for (;;) {
+        unsigned seen = mbox_doorbell(gx);
+        unsigned ready = mbox_pending(gx, o->nplayers);
+        if (ready) {
+            // camino caliente sin syscalls; cada tanto se revisan señales/EOF/timer
+            if ((++polls & 63u) == 0) ready |= poll_events(0, timer);
+            return ready;
+        }
+        mbox_wait_doorbell(gx, seen, FUTEX_SLICE_MS);
+        if (mbox_pending(gx, o->nplayers)) continue;
+
+        // sin respuestas: puede haber muerto un jugador, llegado una señal o vencido el timer
+        ready = poll_events(0, timer);
+        if (ready || *timer || g_stop) return ready;
+    }
+}
+
+static unsigned poll_events(int timeout_ms, bool *timer) {
+    ev_event_t evs[MAXP + 2];
+    int nev = ev_wait(&EV, evs, MAXP + 2, timeout_ms);
+    if (nev < 0) die("epoll_wait: %s", strerror(errno));
+
+    unsigned ready = 0;
+    for (int k = 0; k < nev; ++k) {
+        if (evs[k].kind == EV_FD && evs[k].tag == STATS_TAG) (void)ss_accept(&SS);
+        else if (evs[k].kind == EV_FD) ready |= 1u << evs[k].tag;
+        else if (evs[k].kind == EV_TIMER) *timer = true;
+        else if (ev_read_signal(&EV) > 0) g_stop = 1;
+    }
+    return ready;
+}
+
+static int take_move(const opts_t *o, int i, unsigned char *dir) {
+    if (o->transport == XPORT_FUTEX) {
+        int r = mbox_take(gx, i, dir);
+        if (r != 2) return r;
+        // el buzón está vacío: el pipe (no bloqueante) solo puede avisar EOF si el jugador murió
+    }
+    return proto_read_dir(P.pipes_r[i], dir);
+}
+
+// ============= timeout de inactividad =============
+static void arm_inactivity_deadline(const struct timespec *last_valid, int timeout_s) {
+    struct timespec dl = *last_valid;
+    dl.tv_sec += timeout_s > 0 ? timeout_s : 0;
+    if (ev_set_deadline(&EV, &dl) != 0) die("timerfd_settime: %s", strerror(errno));
+}
+
+static bool inactivity_expired(const struct timespec *last_valid, int timeout_s) {
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    long long elapsed_ms = (now.tv_sec - last_valid->tv_sec)*1000LL + (now.tv_nsec - last_valid->tv_nsec)/1000000LL;
+    return elapsed_ms >= (long long)timeout_s*1000LL;
+}
+
 // ============= spawn helpers =============
 static void spawn_view(const opts_t *o){
     if (!o->view_path) { g_has_view = false; return; }
@@ -409,7 +749,8 @@ static void spawn_view(const opts_t *o){
     pid_t pid = fork();
     if (pid < 0) die("fork(view): %s", strerror(errno));
     if (pid == 0) {
-        // hijo: exec view
+        // hijo: exec view (con la máscara de señales original)
+        sigprocmask(SIG_SETMASK, &g_orig_sigmask, NULL);
         char wbuf[16], hbuf[16];
         snprintf(wbuf, sizeof wbuf, "%d", o->w);
         snprintf(hbuf, sizeof hbuf, "%d", o->h);
@@ -446,6 +787,12 @@ static void spawn_players(const opts_t *o, int pipes[][2]){
                 die_fast("dup2(player[%d]->stdout): %s", i, strerror(errno));
             }
             close(pipes[i][1]);
+            if (o->quiet) {
+                // partidas del servidor: cientos de jugadores, sin su stderr
+                int dn = open("/dev/null", O_WRONLY);
+                if (dn >= 0) { dup2(dn, STDERR_FILENO); close(dn); }
+            }
+            sigprocmask(SIG_SETMASK, &g_orig_sigmask, NULL);
             // exec jugador
             char wbuf[16], hbuf[16];
             snprintf(wbuf, sizeof wbuf, "%d", o->w);
@@ -458,6 +805,11 @@ static void spawn_players(const opts_t *o, int pipes[][2]){
         close(pipes[i][1]);                  // no escribe
         P.pipes_r[i] = pipes[i][0];          // guarda read-end
         set_cloexec(P.pipes_r[i], 1);
+        // con buzones el pipe solo sirve para detectar EOF: que nunca bloquee al máster
+        if (o->transport == XPORT_FUTEX &&
+            fcntl(P.pipes_r[i], F_SETFL, fcntl(P.pipes_r[i], F_GETFL) | O_NONBLOCK) == -1)
+            die("fcntl(O_NONBLOCK): %s", strerror(errno));
+        if (ev_add_fd(&EV, P.pipes_r[i], i) != 0) die("epoll_ctl(player %d): %s", i, strerror(errno));
         gs->players[i].pid = pid;
         // nombre visible (hasta 15 chars, null terminated)
         memset(gs->players[i].name, 0, sizeof(gs->players[i].name));
@@ -466,33 +818,595 @@ static void spawn_players(const opts_t *o, int pipes[][2]){
 }
 
 // ============= procesamiento de un movimiento =============
-static void apply_move_rr(int i, unsigned char dir, int W, int H, int *b, struct timespec *last_valid){
-    // validar dir 0..7
-    if (dir > 7) {
+static void apply_move_rr(int i, unsigned char dir, struct timespec *last_valid){
+    unsigned long long t0 = sync_now_ns();
+    writer_enter(gx);
+    unsigned long long t1 = sync_now_ns();
+    bool valid = gs_apply_move(gs, i, dir); // mismas reglas que tournament
+    writer_exit(gx);
+    unsigned long long t2 = sync_now_ns();
+    lat_add(&i, 1, PH_LOCK_WAIT, t1 - t0);
+    lat_add(&i, 1, PH_LOCK_HOLD, t2 - t1);
+
+    // reset del timer de inactividad
+    if (valid) clock_gettime(CLOCK_MONOTONIC, last_valid);
+}
+
+static int serve_ready_batch(unsigned ready, const opts_t *o, int rr,
+                             struct timespec *last_valid, bool *can_move){
+    int who[MAXP], n = 0, last = -1;
+    unsigned char dirs[MAXP];
+    bool eof[MAXP];
+
+    // 1) leer todo lo que esté listo, en orden RR y fuera del lock
+    for (int off = 0; off < o->nplayers; ++off) {
+        int i = (rr + off) % o->nplayers;
+        if (P.pipes_r[i] < 0 || !(ready & (1u << i))) continue;
+
+        int pr = take_move_timed(o, i, &dirs[n]);
+        if (pr == 2) continue; // wakeup espurio
+        if (pr == 0 || pr == 1) {
+            who[n] = i;
+            eof[n] = (pr == 1);
+            n++;
+        }
+        if (pr != 0) close_player_pipe(i); // EOF o error => cerrar FD
+        last = i;
+    }
+
+    // 2) aplicar todas las jugadas (y EOFs) bajo un único writer_enter
+    //    (la espera y la retención del lock se le cuentan entera a cada jugador del lote)
+    bool any_valid = false;
+    unsigned long long t0 = sync_now_ns();
+    writer_enter(gx);
+    unsigned long long t1 = sync_now_ns();
+    for (int k = 0; k < n; ++k) {
+        if (eof[k]) gs->players[who[k]].blocked = true;
+        else if (gs_apply_move(gs, who[k], dirs[k])) any_valid = true;
+    }
+    unsigned long long t2 = sync_now_ns();
+    gs_mark_blocked_players(gs);
+    unsigned long long t3 = sync_now_ns();
+    *can_move = gs_any_player_can_move(gs);
+    writer_exit(gx);
+    for (int k = 0; k < n; ++k) mlog_put(&MLOG, eof[k] ? MLOG_QUIT | (unsigned)who[k] : (unsigned)who[k], eof[k] ? 0u : dirs[k]);
+    if (n > 0) mlog_put(&MLOG, MLOG_FRAME, 1);
+    if (any_valid) clock_gettime(CLOCK_MONOTONIC, last_valid);
+    lat_add(who, n, PH_LOCK_WAIT, t1 - t0);
+    lat_add(who, n, PH_LOCK_HOLD, t2 - t1);
+    lat_add(who, n, PH_MARK, t3 - t2);
+
+    // 3) publicar una sola vez a la vista y recién ahí habilitar la próxima solicitud
+    if (n > 0) publish_frame(who, n);
+    for (int k = 0; k < n; ++k) {
+        if (eof[k]) continue;
+        grant_turn(who[k]);
+    }
+    return last;
+}
+
+static tick_sched_t *tick_after(int served){
+    if (TICK.mode != TICK_PER_ROUND) return &TICK;
+    // la ronda cierra cuando jugó cada jugador que todavía puede jugar: un bloqueado no suma
+    int alive = 0;
+    for (int i = 0; i < P.nplayers; ++i)
+        if (P.pipes_r[i] >= 0 && !gs->players[i].blocked) alive++;
+    g_round_served += served;
+    if (g_round_served < alive) return NULL;
+    g_round_served = 0;
+    return &TICK;
+}
+
+static void grant_turn(int i){
+    unsigned long long t0 = sync_now_ns();
+    GAP[i].granted_ns = t0;
+    GAP[i].pending = true;
+    if (sync_allow_one_move(gx, i) == -1) die("sync_allow_one_move(%d): %s", i, strerror(errno));
+    lat_add(&i, 1, PH_POST, sync_now_ns() - t0);
+}
+
+static int take_move_timed(const opts_t *o, int i, unsigned char *dir){
+    unsigned long long t0 = sync_now_ns();
+    int pr = take_move(o, i, dir);
+    unsigned long long t1 = sync_now_ns();
+    if (pr != 0) return pr;
+
+    lat_add(&i, 1, PH_READ, t1 - t0);
+    turn_gap_t *g = &GAP[i];
+    if (!g->pending) return pr;
+    g->pending = false;
+    g->n++;
+    unsigned long long at = sync_reply_stamp(gx, i);
+    if (at < g->granted_ns || at > t0) at = t0;  // jugador sin sello: cuenta la llegada
+    else lat_add(&i, 1, PH_READY, t0 - at);
+    lat_add(&i, 1, PH_REPLY, at - g->granted_ns);
+    if (o->gap_log) fprintf(stderr, "[gap] %c #%lu %.1f us\n", 'A' + i, g->n, (double)(at - g->granted_ns) / 1e3);
+    return pr;
+}
+
+static void lat_add(const int *who, int n, int ph, unsigned long long ns){
+    for (int k = 0; k < n; ++k) hist_record(&LAT[who[k]][ph], ns);
+}
+
+static void publish_frame(const int *who, int n){
+    unsigned long long t0 = sync_now_ns();
+    sync_notify_view_and_delay(gx, g_has_view, NULL, &g_stop);
+    if (g_has_view) lat_add(who, n, PH_VIEW, sync_now_ns() - t0);
+    tick_wait(tick_after(n));
+}
+
+static void print_latency(int i){
+    char line[512];
+    int len = snprintf(line, sizeof line, "  latencia us p50/p99/p999:");
+    for (int ph = 0; ph < PH_COUNT && len < (int)sizeof line; ++ph) {
+        const lat_hist_t *h = &LAT[i][ph];
+        if (h->count == 0) continue;
+        len += snprintf(line + len, sizeof line - (size_t)len, " %s %.1f/%.1f/%.1f", PH_NAME[ph],
+                        (double)hist_percentile(h, 0.50) / 1e3, (double)hist_percentile(h, 0.99) / 1e3,
+                        (double)hist_percentile(h, 0.999) / 1e3);
+    }
+    fprintf(stderr, "%s\n", line);
+}
+
+static void write_latency_json(const char *path, int nplayers){
+    FILE *f = fopen(path, "w");
+    if (!f) { fprintf(stderr, "-j %s: %s\n", path, strerror(errno)); return; }
+    fprintf(f, "{\"unit\":\"us\",\"players\":[");
+    for (int i = 0; i < nplayers; ++i) {
+        // nombre con comillas y barras escapadas
+        fprintf(f, "%s\n {\"player\":\"%c\",\"name\":\"", i ? "," : "", 'A' + i);
+        for (const char *c = gs->players[i].name; *c; ++c)
+            fprintf(f, (*c == '"' || *c == '\\') ? "\\%c" : "%c", *c);
+        fprintf(f, "\",\"score\":%u,\"valid\":%u,\"invalid\":%u,\"phases\":{",
+                gs->players[i].score, gs->players[i].valid_moves, gs->players[i].invalid_moves);
+        bool first = true;
+        for (int ph = 0; ph < PH_COUNT; ++ph) {
+            const lat_hist_t *h = &LAT[i][ph];
+            if (h->count == 0) continue;
+            fprintf(f, "%s\"%s\":{\"n\":%llu,\"mean\":%.3f,\"p50\":%.3f,\"p99\":%.3f,\"p999\":%.3f,\"max\":%.3f}",
+                    first ? "" : ",", PH_NAME[ph], (unsigned long long)h->count, hist_mean(h) / 1e3,
+                    (double)hist_percentile(h, 0.50) / 1e3, (double)hist_percentile(h, 0.99) / 1e3,
+                    (double)hist_percentile(h, 0.999) / 1e3, (double)h->max_ns / 1e3);
+            first = false;
+        }
+        fprintf(f, "}}");
+    }
+    fprintf(f, "\n]}\n");
+    if (fclose(f) != 0) fprintf(stderr, "-j %s: %s\n", path, strerror(errno));
+}
+
+static void wait_view(void){
+    int status;
+    if (P.view_pid <= 0) return;
+    if (waitpid(P.view_pid, &status, 0) > 0) {
+        if (WIFEXITED(status))
+            fprintf(stderr, "View exited (%d)\n", WEXITSTATUS(status));
+        else if (WIFSIGNALED(status))
+            fprintf(stderr, "View killed by signal (%d)\n", WTERMSIG(status));
+    }
+}
+
+static void load_replay(opts_t *o){
+    if (mlog_open_read(&RLOG, o->replay_path) != 0) die("-r %s: %s", o->replay_path, strerror(errno));
+    const mlog_header_t *h = RLOG.hdr;
+    o->w = h->width;
+    o->h = h->height;
+    o->seed = h->seed;
+    o->compact = o->compact || (h->flags & GS_F_COMPACT);
+    o->nplayers = h->nplayers;
+    for (int i = 0; i < o->nplayers; ++i) {
+        if (!memchr(h->names[i], '\0', sizeof h->names[i])) die("-r %s: encabezado inválido", o->replay_path);
+        o->pbin[i] = h->names[i];
+    }
+    if (o->w < 10 || o->h < 10 || o->w > GS_MAX_SIDE || o->h > GS_MAX_SIDE || (size_t)o->w * (size_t)o->h > GS_MAX_CELLS)
+        die("-r %s: dimensiones inválidas %dx%d", o->replay_path, o->w, o->h);
+}
+
+static void open_record(const opts_t *o, unsigned gs_flags){
+    mlog_header_t h;
+    memset(&h, 0, sizeof h);
+    memcpy(h.magic, MLOG_MAGIC, sizeof h.magic);
+    h.version = MLOG_VERSION;
+    h.seed = o->seed;
+    h.width = (uint16_t)o->w;
+    h.height = (uint16_t)o->h;
+    h.nplayers = (uint8_t)o->nplayers;
+    h.flags = (uint8_t)gs_flags;
+    for (int i = 0; i < o->nplayers; ++i) memcpy(h.names[i], gs->players[i].name, sizeof h.names[i]);
+    if (mlog_open_write(&MLOG, o->record_path, &h) != 0) die("-R %s: %s", o->record_path, strerror(errno));
+}
+
+static void close_record(const opts_t *o){
+    mlog_result_t res[MAXP];
+    for (int i = 0; i < o->nplayers; ++i) {
+        res[i].score = gs->players[i].score;
+        res[i].valid_moves = gs->players[i].valid_moves;
+        res[i].invalid_moves = gs->players[i].invalid_moves;
+    }
+    unsigned long events = MLOG.events;
+    if (mlog_close(&MLOG, res, o->nplayers) != 0) fprintf(stderr, "-R %s: %s\n", o->record_path, strerror(errno));
+    else fprintf(stderr, "Log: %lu eventos en %s\n", events, o->record_path);
+}
+
+// Cada cuántos eventos el replay revisa el signalfd (Ctrl-C) sin pagar un syscall por jugada
+#define REPLAY_POLL_EVERY 4096u
+
+static int replay_game(const opts_t *o){
+    for (int i = 0; i < o->nplayers; ++i) {
+        gs->players[i].pid = 0;
+        memcpy(gs->players[i].name, RLOG.hdr->names[i], sizeof gs->players[i].name);
+    }
+    spawn_view(o);
+    tick_init(&TICK, o->delay_ms, o->pacing);
+    tick_bind_stop(&TICK, &g_stop, EV.sfd);
+    sync_notify_view_and_delay(gx, g_has_view, &TICK, &g_stop);
+
+    // cada FRAME es una publicación del máster original: un render y un tick (-d 0: sin límite)
+    unsigned long moves = 0;
+    unsigned long long t0 = sync_now_ns();
+    for (size_t k = 0; k < RLOG.nrec && !g_stop; ++k) {
+        unsigned a = RLOG.rec[2 * k], b = RLOG.rec[2 * k + 1];
+        if ((k % REPLAY_POLL_EVERY) == REPLAY_POLL_EVERY - 1) { bool t = false; (void)poll_events(0, &t); }
+        if (a == MLOG_FRAME) {
+            if (b) {
+                writer_enter(gx);
+                gs_mark_blocked_players(gs);
+                writer_exit(gx);
+            }
+            sync_notify_view_and_delay(gx, g_has_view, &TICK, &g_stop);
+            // con pacing el tick corta ante Ctrl-C sin leer el signalfd: atenderlo ya
+            if (TICK.period_ns > 0) { bool t = false; (void)poll_events(0, &t); }
+            stats_publish(o, false);
+            continue;
+        }
+        int i = (int)(a & ~MLOG_QUIT);
+        if (i >= o->nplayers) die("-r %s: evento %zu inválido (%02x %02x)", o->replay_path, k, a, b);
         writer_enter(gx);
-        gs->players[i].invalid_moves++;
+        if (a & MLOG_QUIT) gs->players[i].blocked = true;
+        else gs_apply_move(gs, i, (unsigned char)b);
         writer_exit(gx);
-        return;
+        if (!(a & MLOG_QUIT)) moves++;
     }
-    int x = gs->players[i].x, y = gs->players[i].y;
-    int nx = x + DX[dir], ny = y + DY[dir];
-    bool valid = in_bounds_wh(nx,ny,W,H) && b[idx_wh(nx,ny,W)] > 0;
+    double ms = (double)(sync_now_ns() - t0) / 1e6;
 
     writer_enter(gx);
-    if (!valid || gs->players[i].blocked) {
-        gs->players[i].invalid_moves++;
-        writer_exit(gx);
-        return;
-    }
-    // mover: sumar recompensa, marcar celda, actualizar pos, contadores
-    int reward = b[idx_wh(nx,ny,W)];
-    gs->players[i].score += (unsigned)reward;
-    gs->players[i].valid_moves++;
-    gs->players[i].x = (unsigned short)nx;
-    gs->players[i].y = (unsigned short)ny;
-    b[idx_wh(nx,ny,W)] = -i;  // capturada por jugador i
+    gs->finished = true;
     writer_exit(gx);
+    stats_publish(o, true);
+    sync_notify_view_and_delay(gx, g_has_view, NULL, &g_stop);
+    wait_view();
 
-    // reset del timer de inactividad
-    clock_gettime(CLOCK_MONOTONIC, last_valid);
+    // resultados contra los grabados: mismo log + misma semilla => mismos puntajes
+    int mismatches = 0;
+    for (int i = 0; i < o->nplayers; ++i) {
+        const player_t *p = &gs->players[i];
+        mlog_result_t want;
+        const char *tag = "sin resultado grabado";
+        if (mlog_result_of(&RLOG, i, &want)) {
+            bool same = want.score == p->score && want.valid_moves == p->valid_moves && want.invalid_moves == p->invalid_moves;
+            if (!same) mismatches++;
+            tag = same ? "coincide" : "DIFIERE";
+        }
+        fprintf(stderr, "Player %c %s (%d) replayed with a score of %u / %u / %u (%s)\n",
+                'A' + i, p->name, i, p->score, p->valid_moves, p->invalid_moves, tag);
+    }
+    fprintf(stderr, "Replay: %zu eventos, %lu jugadas en %.3f ms (%.0f jugadas/s)%s\n",
+            RLOG.nrec, moves, ms, ms > 0 ? (double)moves / (ms / 1e3) : 0.0, g_stop ? " [interrumpido]" : "");
+    mlog_close_read(&RLOG);
+    return mismatches ? 1 : 0;
+}
+
+static void stats_publish(const opts_t *o, bool final){
+    static unsigned long long next_ns = 0, prev_ns = 0, seq = 0, start_ns = 0;
+    static unsigned prev_moves[MAXP];
+    if (SS.lfd < 0) return;
+    unsigned long long now = sync_now_ns();
+    if (start_ns == 0) start_ns = prev_ns = now;
+    if (SS.ncli == 0 || (!final && now < next_ns)) return;
+    next_ns = now + STATS_PERIOD_MS * 1000000ull;
+    double dt = (double)(now - prev_ns) / 1e9;
+    prev_ns = now;
+
+    // snapshot de los contadores (lecturas simples: nadie más escribe el estado)
+    char buf[4096];
+    int len = snprintf(buf, sizeof buf, "{\"seq\":%llu,\"t_ms\":%.1f,\"finished\":%s,\"free_cells\":%u,\"players\":[",
+                       ++seq, (double)(now - start_ns) / 1e6, final ? "true" : "false", gs_count_free_cells(gs));
+    for (int i = 0; i < o->nplayers && len < (int)sizeof buf; ++i) {
+        const player_t *p = &gs->players[i];
+        unsigned moves = p->valid_moves + p->invalid_moves;
+        double rate = dt > 0 ? (double)(moves - prev_moves[i]) / dt : 0.0;
+        prev_moves[i] = moves;
+        const lat_hist_t *h = &LAT[i][PH_REPLY];
+        len += snprintf(buf + len, sizeof buf - (size_t)len,
+                        "%s{\"player\":\"%c\",\"score\":%u,\"valid\":%u,\"invalid\":%u,\"blocked\":%s,"
+                        "\"moves_s\":%.1f,\"move_us\":%.1f,\"move_p99_us\":%.1f}",
+                        i ? "," : "", 'A' + i, p->score, p->valid_moves, p->invalid_moves, p->blocked ? "true" : "false",
+                        rate, hist_mean(h) / 1e3, (double)hist_percentile(h, 0.99) / 1e3);
+    }
+    if (len >= (int)sizeof buf - 3) return;  // no entra (no pasa con 9 jugadores)
+    len += snprintf(buf + len, sizeof buf - (size_t)len, "]}\n");
+    ss_broadcast(&SS, buf, (size_t)len);
+}
+
+// Cada cuánto el servidor revisa hijos terminados aunque no lleguen resultados
+#define SERVER_POLL_MS 100
+
+// Worker del cupo group: juega cada partida que lee de jfd y manda su resultado por wfd.
+// Sale con EOF en jfd o ante una señal. No vuelve.
+static void server_worker(const opts_t *o, int group, int cpu, int jfd, int wfd){
+    g_pool_name[0] = '\0';  // el pool es del servidor
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    (void)sched_setaffinity(0, sizeof set, &set);  // best-effort
+
+    pid_t server = getppid();
+    int g;
+    while (!g_stop && read(jfd, &g, sizeof g) == (ssize_t)sizeof g) {
+        // epoll/timerfd propios por partida: nada armado de la anterior (ni el epoll del padre)
+        ev_close(&EV);
+        if (ev_open(&EV, &g_stop_sigs, NULL) != 0) die_fast("ev_open: %s", strerror(errno));
+        char ns[SHM_NS_MAX + 1];
+        snprintf(ns, sizeof ns, "%s.%d.%d", o->shm_ns ? o->shm_ns : "", (int)server, g);
+        setenv(SHM_NS_ENV, ns, 1);
+
+        opts_t go = *o;
+        go.games = 0;
+        go.quiet = true;
+        go.seed = o->seed + (unsigned)g;
+        go.pool_group = POOL ? group : -1;
+        unsigned long long t0 = sync_now_ns();
+        run_game(&go);
+
+        game_result_t r;
+        memset(&r, 0, sizeof r);
+        r.game = g;
+        r.group = group;
+        r.seed = go.seed;
+        r.nplayers = go.nplayers;
+        r.ms = (double)(sync_now_ns() - t0) / 1e6;
+        for (int i = 0; i < go.nplayers; ++i) {
+            r.score[i] = gs->players[i].score;
+            r.valid[i] = gs->players[i].valid_moves;
+            r.invalid[i] = gs->players[i].invalid_moves;
+        }
+        if (write(wfd, &r, sizeof r) != (ssize_t)sizeof r) die_fast("write(resultado): %s", strerror(errno));
+        end_game();  // el padre ya puede mandar la próxima mientras se limpia esta
+    }
+    exit(0);
+}
+
+// Lanza el worker del cupo g con su pipe de trabajos (write-end en jobs[g]).
+static pid_t spawn_server_worker(const opts_t *o, int g, int cpu, int *jobs, int njobs, const int rp[2]){
+    int jp[2];
+    if (pipe(jp) == -1) die("pipe(trabajos): %s", strerror(errno));
+    fflush(stdout); // que el worker no herede (y repita) líneas sin vaciar
+    pid_t pid = fork();
+    if (pid < 0) die("fork(worker): %s", strerror(errno));
+    if (pid == 0) {
+        // los write-end de los otros cupos no: su EOF es la orden de salir
+        for (int k = 0; k < njobs; ++k) if (jobs[k] >= 0) close(jobs[k]);
+        close(jp[1]);
+        close(rp[0]);
+        set_cloexec(jp[0], 1);
+        server_worker(o, g, cpu, jp[0], rp[1]);
+    }
+    close(jp[0]);
+    set_cloexec(jp[1], 1);
+    jobs[g] = jp[1];
+    return pid;
+}
+
+// Retira el worker del cupo g: EOF en su pipe de trabajos y esperarlo.
+static void retire_server_worker(pid_t *wpid, int *jobs, int g){
+    if (jobs[g] >= 0) close(jobs[g]);
+    jobs[g] = -1;
+    if (wpid[g] > 0) waitpid(wpid[g], NULL, 0);
+    wpid[g] = 0;
+}
+
+static int serve_games(const opts_t *o){
+    int rp[2];
+    if (pipe(rp) == -1) die("pipe: %s", strerror(errno));
+    set_cloexec(rp[0], 1);
+    set_cloexec(rp[1], 1);
+    if (fcntl(rp[0], F_SETFL, fcntl(rp[0], F_GETFL) | O_NONBLOCK) == -1) die("fcntl(O_NONBLOCK): %s", strerror(errno));
+    if (ev_add_fd(&EV, rp[0], 0) != 0) die("epoll_ctl(resultados): %s", strerror(errno));
+
+    long ncpu = sysconf(_SC_NPROCESSORS_ONLN);
+    if (ncpu < 1) ncpu = 1;
+    int jobs = o->jobs > 0 ? o->jobs : (int)ncpu;
+    if (jobs > o->games) jobs = o->games;
+    printf("server: %d partidas %dx%d, %d jugadores, hasta %d a la vez en %ld núcleos, seed %u..%u%s\n",
+           o->games, o->w, o->h, o->nplayers, jobs, ncpu, o->seed, o->seed + (unsigned)o->games - 1,
+           o->keep_players ? ", jugadores persistentes" : "");
+    fflush(stdout);
+
+    // cupo g => su worker, su pipe de trabajos y la partida que juega (-1 = libre); con -k
+    // también su grupo de slots del pool. stale: un jugador del grupo se relanzó y el worker
+    // no tiene su pipe, se reemplaza en cuanto queda libre.
+    pid_t *wpid = calloc((size_t)jobs, sizeof *wpid);
+    int *wjob = malloc((size_t)jobs * sizeof *wjob);
+    int *wgame = malloc((size_t)jobs * sizeof *wgame);
+    bool *stale = calloc((size_t)jobs, sizeof *stale);
+    if (!wpid || !wjob || !wgame || !stale) die("calloc(cupos): %s", strerror(errno));
+    for (int g = 0; g < jobs; ++g) { wjob[g] = -1; wgame[g] = -1; }
+    int nslots = o->keep_players ? jobs * o->nplayers : 0;
+    if (o->keep_players) {
+        snprintf(g_pool_name, sizeof g_pool_name, "%s%s.%d", SHM_POOL, o->shm_ns ? o->shm_ns : "", (int)getpid());
+        if (pool_create(&POOL, &POOL_BYTES, g_pool_name, (unsigned)nslots) != 0)
+            die("pool_create(%s): %s", g_pool_name, strerror(errno));
+        if (!(POOL_FD = malloc((size_t)nslots * sizeof *POOL_FD))) die("malloc(pool): %s", strerror(errno));
+        for (int k = 0; k < nslots; ++k) { POOL_FD[k] = -1; spawn_pool_player(o, k); }
+    }
+    // después del pool: los workers heredan su mapeo y los read-end de sus jugadores
+    for (int g = 0; g < jobs; ++g) wpid[g] = spawn_server_worker(o, g, g % (int)ncpu, wjob, jobs, rp);
+
+    unsigned long wins[MAXP] = {0}, moves = 0;
+    double score_sum[MAXP] = {0}, game_ms = 0;
+    int started = 0, running = 0, reported = 0, failed = 0, respawned = 0;
+    unsigned long long t0 = sync_now_ns();
+    while ((started < o->games && !g_stop) || running > 0) {
+        // a) repartir: cada cupo libre recibe la próxima partida
+        for (int g = 0; g < jobs && !g_stop && started < o->games; ++g) {
+            if (wgame[g] >= 0) continue;
+            if (stale[g] || wpid[g] == 0) {
+                retire_server_worker(wpid, wjob, g);
+                wpid[g] = spawn_server_worker(o, g, g % (int)ncpu, wjob, jobs, rp);
+                stale[g] = false;
+            }
+            if (write(wjob[g], &started, sizeof started) != (ssize_t)sizeof started)
+                die("write(trabajo %d): %s", g, strerror(errno));
+            wgame[g] = started++;
+            running++;
+        }
+
+        // b) resultados (o señal, o timeout para cosechar procesos muertos)
+        ev_event_t evs[4];
+        int nev = ev_wait(&EV, evs, 4, SERVER_POLL_MS);
+        for (int k = 0; k < nev; ++k)
+            if (evs[k].kind == EV_SIGNAL && ev_read_signal(&EV) > 0) g_stop = 1;
+        game_result_t r;
+        while (read(rp[0], &r, sizeof r) == (ssize_t)sizeof r) {
+            if (r.group < 0 || r.group >= jobs || wgame[r.group] != r.game) continue; // ya contada como fallida
+            wgame[r.group] = -1;
+            running--;
+            int best = 0;
+            for (int i = 0; i < r.nplayers; ++i) {
+                score_sum[i] += r.score[i];
+                moves += r.valid[i] + r.invalid[i];
+                if (r.score[i] > r.score[best]) best = i;
+            }
+            wins[best]++;
+            game_ms += r.ms;
+            reported++;
+            printf("game %d seed %u %.1f ms:", r.game, r.seed, r.ms);
+            for (int i = 0; i < r.nplayers; ++i) printf(" %u", r.score[i]);
+            printf("\n");
+        }
+
+        // c) cosechar: un worker muerto pierde su partida (se relanza al repartir); un jugador
+        //    del pool muerto se relanza y deja viejo al worker de su grupo
+        int st;
+        pid_t w;
+        while ((w = waitpid(-1, &st, WNOHANG)) > 0) {
+            int g = 0;
+            while (g < jobs && wpid[g] != w) g++;
+            if (g < jobs) {
+                wpid[g] = 0;
+                if (wgame[g] >= 0) { wgame[g] = -1; running--; failed++; }
+                continue;
+            }
+            for (int k = 0; k < nslots; ++k) {
+                if (atomic_load(&POOL->slot[k].pid) != w) continue;
+                atomic_store(&POOL->slot[k].pid, 0);
+                if (!g_stop) { spawn_pool_player(o, k); respawned++; stale[k / o->nplayers] = true; }
+            }
+        }
+    }
+    fflush(stdout);
+    // sin más trabajos: cada worker sale al ver EOF
+    for (int g = 0; g < jobs; ++g) retire_server_worker(wpid, wjob, g);
+    close(rp[0]);
+    close(rp[1]);
+    free(wpid);
+    free(wjob);
+    free(wgame);
+    free(stale);
+
+    if (POOL) {
+        // fin del pool: cada jugador sale al ver POOL_EXIT (si alguno no, SIGKILL)
+        for (int k = 0; k < nslots; ++k) pool_post(&POOL->slot[k], POOL_EXIT, NULL, -1);
+        for (int k = 0; k < nslots; ++k) {
+            pid_t pid = atomic_load(&POOL->slot[k].pid);
+            int tries = 0;
+            while (pid > 0 && waitpid(pid, NULL, WNOHANG) == 0) {
+                if (++tries > 100) { kill(pid, SIGKILL); waitpid(pid, NULL, 0); break; }
+                struct timespec ts = { 0, 10 * 1000000L };
+                nanosleep(&ts, NULL);
+            }
+            if (POOL_FD[k] >= 0) close(POOL_FD[k]);
+        }
+        free(POOL_FD);
+        POOL_FD = NULL;
+        pool_close(POOL, POOL_BYTES);
+        POOL = NULL;
+        shm_unlink(g_pool_name);
+        g_pool_name[0] = '\0';
+    }
+
+    double ms = (double)(sync_now_ns() - t0) / 1e6;
+    fprintf(stderr, "Server: %d/%d partidas en %.1f ms (%.1f partidas/s, %.0f jugadas/s), media por partida %.1f ms%s\n",
+            reported, o->games, ms, reported / (ms / 1e3), (double)moves / (ms / 1e3),
+            reported ? game_ms / reported : 0.0, g_stop ? " [interrumpido]" : "");
+    for (int i = 0; i < o->nplayers && reported > 0; ++i)
+        fprintf(stderr, "Player %c %s: %lu victorias, puntaje medio %.1f\n",
+                'A' + i, base_name(o->pbin[i]), wins[i], score_sum[i] / reported);
+    if (nslots) fprintf(stderr, "Server: pool de %d jugadores persistentes (%d relanzados)\n", nslots, respawned);
+    if (failed) fprintf(stderr, "Server: %d partidas terminaron con error\n", failed);
+    return failed ? 1 : 0;
+}
+
+// ============= pool de jugadores (-k) =============
+static void spawn_pool_player(const opts_t *o, int k){
+    int fds[2];
+    if (pipe(fds) == -1) die("pipe(pool): %s", strerror(errno));
+    pid_t server = getpid();
+    pid_t pid = fork();
+    if (pid < 0) die("fork(pool): %s", strerror(errno));
+    if (pid == 0) {
+        // stdout: pipe al servidor (EOF = murió); stderr a /dev/null como en las partidas
+        if (dup2(fds[1], STDOUT_FILENO) == -1) die_fast("dup2(pool[%d]->stdout): %s", k, strerror(errno));
+        close(fds[0]);
+        close(fds[1]);
+        int dn = open("/dev/null", O_WRONLY);
+        if (dn >= 0) { dup2(dn, STDERR_FILENO); close(dn); }
+        // si el servidor muere el jugador no tiene quién le avise: que muera con él
+        prctl(PR_SET_PDEATHSIG, SIGTERM);
+        if (getppid() != server) _exit(1);
+        sigprocmask(SIG_SETMASK, &g_orig_sigmask, NULL);
+        char slot[16], wbuf[16], hbuf[16];
+        snprintf(slot, sizeof slot, "%d", k);
+        snprintf(wbuf, sizeof wbuf, "%d", o->w);
+        snprintf(hbuf, sizeof hbuf, "%d", o->h);
+        setenv(POOL_ENV, g_pool_name, 1);
+        setenv(POOL_SLOT_ENV, slot, 1);
+        const char *bin = o->pbin[k % o->nplayers];
+        execl(bin, bin, wbuf, hbuf, (char*)NULL);
+        die_fast("exec(player '%s'): %s", bin, strerror(errno));
+    }
+    close(fds[1]);
+    if (POOL_FD[k] >= 0) close(POOL_FD[k]);
+    POOL_FD[k] = fds[0];
+    set_cloexec(fds[0], 1);
+    if (fcntl(fds[0], F_SETFL, fcntl(fds[0], F_GETFL) | O_NONBLOCK) == -1) die("fcntl(O_NONBLOCK): %s", strerror(errno));
+    atomic_store(&POOL->slot[k].pid, pid);
+}
+
+static void attach_pool_players(const opts_t *o){
+    const char *ns = getenv(SHM_NS_ENV);
+    for (int i = 0; i < o->nplayers; ++i) {
+        int k = o->pool_group * o->nplayers + i;
+        // copia propia del read-end: close_player_pipe no toca el del servidor
+        P.pipes_r[i] = dup(POOL_FD[k]);
+        if (P.pipes_r[i] < 0) die("dup(pool[%d]): %s", k, strerror(errno));
+        set_cloexec(P.pipes_r[i], 1);
+        if (ev_add_fd(&EV, P.pipes_r[i], i) != 0) die("epoll_ctl(player %d): %s", i, strerror(errno));
+        gs->players[i].pid = atomic_load(&POOL->slot[k].pid);
+        memset(gs->players[i].name, 0, sizeof(gs->players[i].name));
+        strncpy(gs->players[i].name, base_name(o->pbin[i]), sizeof(gs->players[i].name)-1);
+    }
+    // players[] ya está completo: el aviso lleva el índice, nadie se busca por pid
+    for (int i = 0; i < o->nplayers; ++i)
+        POOL_SEQ[i] = pool_post(&POOL->slot[o->pool_group * o->nplayers + i], POOL_GAME, ns, i);
+}
+
+static void release_pool_players(const opts_t *o, int grace_ms){
+    unsigned long long deadline = sync_now_ns() + (unsigned long long)grace_ms * 1000000ull;
+    for (int i = 0; i < o->nplayers; ++i) {
+        unsigned long long now = sync_now_ns();
+        int left_ms = now < deadline ? (int)((deadline - now) / 1000000ull) : 0;
+        pool_wait_done(&POOL->slot[o->pool_group * o->nplayers + i], POOL_SEQ[i], left_ms);
+        close_player_pipe(i);
+    }
 }
@@ -0,0 +1,100 @@
+#define _DEFAULT_SOURCE
+#include "move_log.h"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <string.h>
+#include <errno.h>
+
+/* write(2) completo (reintenta escrituras parciales y EINTR) */
+static int write_all(int fd, const void *p, size_t n){
+    const unsigned char *b = p;
+    while (n > 0) {
+        ssize_t k = write(fd, b, n);
+        if (k < 0) { if (errno == EINTR) continue; return -1; }
+        b += k; n -= (size_t)k;
+    }
+    return 0;
+}
+
+int mlog_open_write(mlog_writer_t *w, const char *path, const mlog_header_t *h){
+    w->len = 0;
+    w->events = 0;
+    w->fd = open(path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (w->fd < 0) return -1;
+    if (write_all(w->fd, h, sizeof *h) != 0) {
+        int e = errno; close(w->fd); w->fd = -1; errno = e;
+        return -1;
+    }
+    return 0;
+}
+
+int mlog_flush(mlog_writer_t *w){
+    if (w->fd < 0) return -1;
+    if (w->len == 0) return 0;
+    if (write_all(w->fd, w->buf, w->len) != 0) {
+        int e = errno; close(w->fd); w->fd = -1; errno = e;
+        return -1;
+    }
+    w->len = 0;
+    return 0;
+}
+
+int mlog_close(mlog_writer_t *w, const mlog_result_t *res, int nplayers){
+    if (w->fd < 0) return -1;
+    mlog_put(w, MLOG_END, 0);
+    int rc = mlog_flush(w);
+    if (rc == 0) rc = write_all(w->fd, res, (size_t)nplayers * sizeof *res);
+    if (w->fd >= 0 && close(w->fd) != 0) rc = -1;
+    w->fd = -1;
+    return rc;
+}
+
+int mlog_open_read(mlog_reader_t *r, const char *path){
+    memset(r, 0, sizeof *r);
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return -1;
+    struct stat st;
+    if (fstat(fd, &st) != 0) { int e = errno; close(fd); errno = e; return -1; }
+    if ((size_t)st.st_size < sizeof(mlog_header_t)) { close(fd); errno = EINVAL; return -1; }
+
+    void *m = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    int e = errno;
+    close(fd);
+    if (m == MAP_FAILED) { errno = e; return -1; }
+    r->map = m;
+    r->map_bytes = (size_t)st.st_size;
+    r->hdr = m;
+    if (memcmp(r->hdr->magic, MLOG_MAGIC, sizeof r->hdr->magic) != 0 || r->hdr->version != MLOG_VERSION ||
+        r->hdr->nplayers < 1 || r->hdr->nplayers > MAXP) {
+        mlog_close_read(r);
+        errno = EINVAL;
+        return -1;
+    }
+
+    // registros hasta MLOG_END; sin él (máster cortado) se reproduce lo que haya
+    r->rec = (const unsigned char *)m + sizeof(mlog_header_t);
+    size_t avail = (r->map_bytes - sizeof(mlog_header_t)) / 2u;
+    r->nrec = avail;
+    for (size_t k = 0; k < avail; ++k) {
+        if (r->rec[2 * k] != MLOG_END) continue;
+        r->nrec = k;
+        size_t tail = sizeof(mlog_header_t) + 2u * (k + 1u);
+        if (r->map_bytes - tail >= (size_t)r->hdr->nplayers * sizeof(mlog_result_t))
+            r->result = (const unsigned char *)m + tail;
+        break;
+    }
+    return 0;
+}
+
+void mlog_close_read(mlog_reader_t *r){
+    if (r->map) munmap(r->map, r->map_bytes);
+    memset(r, 0, sizeof *r);
+}
+
+bool mlog_result_of(const mlog_reader_t *r, int i, mlog_result_t *out){
+    if (!r->result || i < 0 || i >= r->hdr->nplayers) return false;
+    memcpy(out, r->result + (size_t)i * sizeof *out, sizeof *out);
+    return true;
+}
@@ -8,17 +8,93 @@
 #include <sys/mman.h>
 #include <sys/stat.h>
 #include <errno.h>
+#include <time.h>
 #include "shared_mem.h"
 #include "sync_utils.h"
 #include "game_utils.h"
 #include "player_strategies.h"
+#include "search.h"             // SEARCH_DEFAULT_BUDGET_MS
+#include "bitboard.h"           // bb_row_bits
+#include "player_pool.h"        // modo pool: jugador persistente entre partidas
 
 
 //puntero a memorias compartidas
 static game_sync_t  *gx = NULL;
 game_state_t *gs = NULL;   
+static size_t GS_BYTES = 0;
+static game_state_t *snap = NULL;   // copia privada del estado: se decide siempre sobre ella
+static bool versioned = false;      // el máster publica sync_state_version (no es uno de la cátedra)
 
-static int my_index_by_pid(pid_t me);
+static int my_index_by_pid(const game_state_t *st, pid_t me);
+// El máster anota el pid en players[] recién después del fork: si el jugador llegó antes,
+// relee el encabezado cada PID_WAIT_MS hasta encontrarse (o hasta PID_WAIT_TRIES intentos).
+static int find_my_index(void);
+#define PID_WAIT_MS    1
+#define PID_WAIT_TRIES 2000
+
+// ===== Partida =====
+// Mapea /game_state y /game_sync del namespace actual y arma el snapshot. Devuelve 0 si ok;
+// si no, -1 (errno) y en *what el paso que falló.
+static int  attach_game(const char **what);
+static void detach_game(void);
+// Elige la estrategia y juega hasta que termine la partida o no haya jugadas.
+// pooled: el stdout es del pool (no se cierra al retirarse).
+static void play_game(int myi, bool pooled);
+// Modo pool (CHOMP_POOL): una partida por aviso hasta POOL_EXIT.
+static int  pool_main(const char *pool_name);
+
+// ===== Decisión especulativa =====
+// Mientras el máster atiende a los demás, el jugador decide sobre un snapshot privado
+// (sin tener ningún lock). Al recibir el turno solo relee una huella chica del entorno:
+// si no cambió, responde al instante con la jugada ya calculada.
+// Las heurísticas leen la ventana 7x7 propia y rivales a distancia <= 4 (+ sus vecinos):
+// con radio 5 la huella cubre todo lo que usan (search y territory miran más lejos: ahí es aproximada).
+// Ya especulada, el jugador duerme en el turno y la revalida una vez al despertar (si la versión
+// del estado no cambió, sync_state_version, ni siquiera relee la huella).
+#define SPEC_R       5                  // radio de la ventana que se valida (11x11)
+#define SPEC_SIDE    (2 * SPEC_R + 1)
+#define SPEC_POLL_MS 1                  // cada cuánto se mira la versión mientras no se aplicó mi jugada
+
+typedef struct {
+    int x, y;                           // mi posición
+    bool blocked;
+    uint16_t win[SPEC_SIDE];            // libres de la ventana (fila r = y-SPEC_R+r, bit c = x-SPEC_R+c)
+    uint64_t near[MAXP];                // rivales dentro de la ventana (x|y<<16|blocked<<32), ~0 si afuera
+} spec_fp_t;
+
+typedef struct {
+    bool valid;
+    unsigned char dir;                  // jugada decidida sobre el snapshot
+    spec_fp_t fp;
+    unsigned ver;                       // versión del estado con la que se tomó/revalidó fp
+} spec_t;
+
+// ===== Copia para decidir =====
+// Bajo un lock de lector corto solo se copian a `snap` el encabezado y las filas que lee la
+// estrategia (strategy_rows: ±5 filas; ±TERR_RADIUS para territory, todas para search). La
+// decisión corre sin lock.
+typedef struct {
+    unsigned long n;                    // copias hechas
+    double hold_us;                     // tiempo con el lock tomado (copia)
+    double decide_us;                   // tiempo de decisión, ya fuera del lock
+    size_t bytes;                       // bytes copiados
+} copy_stats_t;
+static copy_stats_t CS;
+
+// Copia y decide; en *ver (si no es NULL) la versión del estado copiado.
+static unsigned char decide_on_copy(strategy_t strat, int myi, unsigned *ver);
+
+// Lo que se mira del encabezado antes de decidir (lock de lector corto / lectura optimista)
+typedef struct {
+    bool finished;
+    unsigned moves;                     // mis jugadas aplicadas (válidas + inválidas)
+    unsigned free_cells;
+    unsigned ver;                       // versión del estado leído
+} spec_peek_t;
+static void spec_peek(spec_peek_t *pk, int myi);
+
+static int  wait_turn_speculating(int myi, strategy_t *strat, unsigned sent, spec_t *sp);
+static bool spec_still_valid(spec_t *sp, int myi, bool *finished);
 
 /* ================= main ================= */
 
@@ -34,56 +110,330 @@ int main(int argc, char **argv) {
     fprintf(stderr, "[%d] Jugador iniciado con tablero %dx%d\n",
             getpid(), arg_width, arg_height); //chequeo de funcionamiento
 
-    size_t GS_BYTES = 0;
-    if (gs_open_ro(&gs, &GS_BYTES) != 0) die("gs_open_ro: %s", strerror(errno));
-    if (gx_open_rw(&gx) != 0) die("gx_open_rw: %s", strerror(errno));
+    // CHOMP_SEARCH_THREADS: pool de hilos para search, una vez por proceso (sirve a todas las partidas)
+    const char *threads = getenv("CHOMP_SEARCH_THREADS");
+    if (threads && atoi(threads) > 0)
+        fprintf(stderr, "[%d] search en paralelo: %d hilos\n", getpid(), strategy_set_search_threads(atoi(threads)));
 
+    const char *pool_name = getenv(POOL_ENV);
+    if (pool_name) return pool_main(pool_name);
 
-    // Buscar mi índice por PID en players[]
-    pid_t me = getpid();
-    reader_enter(gx);
-    int myi = my_index_by_pid(me);
-    reader_exit(gx);
+    const char *what;
+    if (attach_game(&what) != 0) die("%s: %s", what, strerror(errno));
 
-   // ELEGIR ESTRATEGIA INICIAL
-   strategy_t strat = choose_strategy(gs->width, gs->height, gs->num_players, myi);
+    // Buscar mi índice por PID en players[] (sobre la copia base de attach_game)
+    int myi = find_my_index();
 
-   for (;;) {
-       reader_enter(gx);
-       bool finished = gs->finished;
-       unsigned int total = (unsigned int)gs->width * (unsigned int)gs->height;
-       unsigned int freec = gs_count_free_cells(gs);
-       bool to_end = should_switch_to_endgame(freec, total);
-       reader_exit(gx);
+    play_game(myi, false);
+
+    // Limpieza
+    detach_game();
+    return 0;
+}
 
-       if (finished) break;
+/* ================= partida ================= */
 
-       if (sync_wait_my_turn(gx, myi) == -1) break;
+static int attach_game(const char **what) {
+    *what = "gs_open_ro";
+    if (gs_open_ro(&gs, &GS_BYTES) != 0) return -1;
+    *what = "gx_open_rw";
+    if (gx_open_rw(&gx) != 0) { int e = errno; gs_close(gs, GS_BYTES); gs = NULL; errno = e; return -1; }
+    *what = "malloc(snapshot)";
+    if (!(snap = malloc(GS_BYTES))) {
+        int e = errno; gx_close(gx); gs_close(gs, GS_BYTES); gx = NULL; gs = NULL; errno = e;
+        return -1;
+    }
+    if (gx->sync_mode != SYNC_SEQLOCK) {   // máster sin zona extendida: gs es una sombra local
+        reader_enter(gx);
+        gs_ro_refresh(gs);
+        reader_exit(gx);
+    }
+    sync_read_snapshot(gx, snap, gs, GS_BYTES);   // base completa: después se refrescan filas
+    versioned = !(gs_ext(gs)->flags & GS_F_SHADOW);
+    return 0;
+}
 
-       reader_enter(gx);
-       if (to_end) strat = STRAT_ENDGAME_HARVEST; // una vez activado, queda
-       unsigned char dir = pick_move_strategy(strat, gs, myi);
-       reader_exit(gx);
+static void detach_game(void) {
+    free(snap);
+    gs_close(gs, GS_BYTES);
+    gx_close(gx);
+    snap = NULL; gs = NULL; gx = NULL;
+}
 
-       if (dir == 255) { close(STDOUT_FILENO); break; }
+static void play_game(int myi, bool pooled) {
+    if (myi >= 0) sync_prof_bind(gx, PROF_SLOT_PLAYER(myi));
+    memset(&CS, 0, sizeof CS);
+
+   // ELEGIR ESTRATEGIA INICIAL (CHOMP_STRATEGY fuerza una por nombre, p.ej. "search")
+   strategy_t strat = choose_strategy(gs->width, gs->height, gs->num_players, myi);
+   const char *env = getenv("CHOMP_STRATEGY");
+   if (env && strategy_from_name(env, &strat) != 0) die("CHOMP_STRATEGY desconocida: %s", env);
+   if (strat == STRAT_SEARCH) {
+       // presupuesto por jugada: CHOMP_SEARCH_MS (default 10) y tope de plies CHOMP_SEARCH_DEPTH
+       const char *ms = getenv("CHOMP_SEARCH_MS"), *depth = getenv("CHOMP_SEARCH_DEPTH");
+       unsigned budget = ms ? (unsigned)strtoul(ms, NULL, 10) : SEARCH_DEFAULT_BUDGET_MS;
+       int max_depth = depth ? atoi(depth) : 0;
+       if (budget == 0 && max_depth <= 0) budget = SEARCH_DEFAULT_BUDGET_MS;
+       strategy_set_search_limits(budget, max_depth);
+   }
+
+   spec_t spec;
+   unsigned sent = 0, spec_hits = 0;    // jugadas enviadas / respondidas con la especulación
+   for (;;) {
+       if (wait_turn_speculating(myi, &strat, sent, &spec) != 0) break;
+
+       bool finished = false, hit;
+       unsigned char dir;
+       if ((hit = spec_still_valid(&spec, myi, &finished))) {
+           dir = spec.dir;
+       } else {
+           if (finished) break;
+           dir = decide_on_copy(strat, myi, NULL);
+       }
+
+       if (dir == 255) {
+           if (gx->transport == XPORT_FUTEX) mbox_close(gx, myi);
+           if (!pooled) close(STDOUT_FILENO);
+           break;
+       }
+       sent++;
+       spec_hits += hit;
+       sync_stamp_reply(gx, myi);   // para que el máster mida permiso → jugada
+       if (gx->transport == XPORT_FUTEX) {
+           // buzón en shm: sin pipe ni semáforo por jugada
+           mbox_reply(gx, myi, dir);
+           continue;
+       }
        if (proto_write_dir(STDOUT_FILENO, dir) != 0) break;
    }
+   if (sent > 0)
+       fprintf(stderr, "[%d] especulación: %u/%u jugadas sin recalcular\n", getpid(), spec_hits, sent);
+   if (CS.n > 0)
+       fprintf(stderr, "[%d] lock de lector: %.1f us por decisión (copia de %zu B); decisión sin lock: %.1f us\n",
+               getpid(), CS.hold_us / (double)CS.n, CS.bytes / CS.n, CS.decide_us / (double)CS.n);
+}
 
-    // Limpieza
-    gs_close(gs, GS_BYTES);
-    gx_close(gx);
+/* ================= modo pool ================= */
+
+static int pool_main(const char *pool_name) {
+    player_pool_t *pool;
+    size_t pool_bytes;
+    if (pool_open(&pool, &pool_bytes, pool_name) != 0) die("pool_open(%s): %s", pool_name, strerror(errno));
+    const char *sl = getenv(POOL_SLOT_ENV);
+    unsigned k = sl ? (unsigned)strtoul(sl, NULL, 10) : pool->nslots;
+    if (k >= pool->nslots) die("%s inválido: %s", POOL_SLOT_ENV, sl ? sl : "(sin definir)");
+    pool_slot_t *s = &pool->slot[k];
+
+    // done = último aviso atendido por este slot: si ya hay uno nuevo se juega enseguida
+    unsigned seen = atomic_load(&s->done);
+    unsigned games = 0;
+    for (;;) {
+        seen = pool_wait(s, seen);
+        if (atomic_load(&s->cmd) == POOL_EXIT) break;
 
+        // el índice llega en el aviso: no hace falta buscarse por pid en players[]
+        setenv(SHM_NS_ENV, s->ns, 1);
+        const char *what;
+        if (attach_game(&what) == 0) {
+            play_game(s->index, true);
+            detach_game();
+            games++;
+        } else {
+            fprintf(stderr, "[%d] pool: %s(ns '%s'): %s\n", getpid(), what, s->ns, strerror(errno));
+        }
+        pool_done(s, seen);
+    }
+    fprintf(stderr, "[%d] pool: %u partidas\n", getpid(), games);
+    pool_close(pool, pool_bytes);
     return 0;
 }
 
 /* ================= busca ID ================= */
 
-static int my_index_by_pid(pid_t me) {
-    unsigned int np = gs->num_players;
+static int my_index_by_pid(const game_state_t *st, pid_t me) {
+    unsigned int np = st->num_players;
     if (np > 9) np = 9;
     for (unsigned int i = 0; i < np; i++) {
-        if (gs->players[i].pid == me) return (int)i;
+        if (st->players[i].pid == me) return (int)i;
     }
     return -1;
 }
 
+static int find_my_index(void) {
+    pid_t me = getpid();
+    for (int tries = 0;; ++tries) {
+        int myi = my_index_by_pid(snap, me);
+        if (myi >= 0 || snap->finished || tries >= PID_WAIT_TRIES) return myi;
+        struct timespec ts = { 0, PID_WAIT_MS * 1000000L };
+        nanosleep(&ts, NULL);
+        // solo encabezado y players: gs_copy_rows con un rango vacío
+        if (gx->sync_mode == SYNC_SEQLOCK) {
+            unsigned s;
+            do {
+                s = sync_read_begin(gx);
+                gs_copy_rows(snap, gs, 0, 0);
+            } while (sync_read_retry(gx, s));
+        } else {
+            reader_enter(gx);
+            gs_ro_refresh(gs);
+            gs_copy_rows(snap, gs, 0, 0);
+            reader_exit(gx);
+        }
+    }
+}
+
+
+/* ================= copia para decidir ================= */
+
+static double now_us(void) {
+    return (double)sync_now_ns() / 1e3;
+}
+
+// Copia a snap las filas que lee strat alrededor de myi (todas si strategy_rows da -1)
+static size_t copy_rows_for(strategy_t strat, int myi) {
+    int r = strategy_rows(strat, gs->height);
+    if (r < 0) return gs_copy_rows(snap, gs, 0, gs->height);
+    int y = gs->players[myi].y;
+    return gs_copy_rows(snap, gs, y - r, y + r + 1);
+}
+
+static unsigned char decide_on_copy(strategy_t strat, int myi, unsigned *ver) {
+    double t0, t1;
+    size_t bytes;
+    unsigned v;
+    if (gx->sync_mode == SYNC_SEQLOCK) {
+        do {
+            v = sync_read_begin(gx);
+            t0 = now_us();
+            bytes = copy_rows_for(strat, myi);
+            t1 = now_us();
+        } while (sync_read_retry(gx, v));
+    } else {
+        reader_enter(gx);
+        t0 = now_us();
+        gs_ro_refresh(gs);
+        v = sync_state_version(gx);
+        bytes = copy_rows_for(strat, myi);
+        t1 = now_us();
+        reader_exit(gx);
+    }
+    if (ver) *ver = v;
+    unsigned char dir = snap->finished ? 255 : pick_move_strategy(strat, snap, myi);
+    CS.n++;
+    CS.hold_us += t1 - t0;
+    CS.decide_us += now_us() - t1;
+    CS.bytes += bytes;
+    return dir;
+}
+
+/* ================= especulación ================= */
+
+// Huella del entorno de `me`: libres de la ventana SPEC_SIDE x SPEC_SIDE (recortada al tablero) y rivales dentro.
+static void spec_fingerprint(spec_fp_t *fp, const game_state_t *st, int me) {
+    memset(fp, 0, sizeof *fp);   // el padding también entra en el memcmp
+    gs_cells_t b; gs_cells_bind(&b, st);
+    const player_t *p = &st->players[me];
+    fp->x = p->x; fp->y = p->y; fp->blocked = p->blocked;
+
+    // bb_row_bits admite x >= -GS_BITS_PAD y hasta W-1+GS_BITS_PAD: recortar la ventana
+    int x0 = fp->x - SPEC_R, skip = 0;
+    if (x0 < -GS_BITS_PAD) { skip = -GS_BITS_PAD - x0; x0 = -GS_BITS_PAD; }
+    int n = SPEC_SIDE - skip, room = b.W + GS_BITS_PAD - x0;
+    if (n > room) n = room;
+    for (int r = 0; r < SPEC_SIDE; ++r) {
+        int y = fp->y - SPEC_R + r;
+        if (y < 0 || y >= b.H || n <= 0) continue;
+        fp->win[r] = (uint16_t)(bb_row_bits(&b, x0, y, (unsigned)n) << skip);
+    }
+
+    unsigned np = st->num_players > MAXP ? MAXP : st->num_players;
+    for (unsigned i = 0; i < MAXP; ++i) {
+        fp->near[i] = ~0ull;
+        if (i >= np || (int)i == me) continue;
+        const player_t *q = &st->players[i];
+        if (abs((int)q->x - fp->x) <= SPEC_R && abs((int)q->y - fp->y) <= SPEC_R)
+            fp->near[i] = (uint64_t)q->x | (uint64_t)q->y << 16 | (uint64_t)q->blocked << 32;
+    }
+}
+
+// Espera el turno. En cuanto el máster aplicó mi jugada anterior decide sobre un snapshot
+// privado mientras los demás juegan; con la jugada ya especulada duerme en el turno sin mirar
+// el estado (play_game la revalida una vez al despertar). Devuelve 0 con el turno tomado, -1
+// si terminó o falló.
+static int wait_turn_speculating(int myi, strategy_t *strat, unsigned sent, spec_t *sp) {
+    sp->valid = false;
+    if (myi < 0) return -1;
+    bool looked = false;
+    unsigned seen = 0;                  // versión de la última mirada al encabezado
+    for (;;) {
+        // hasta que el máster aplique mi jugada no hay nada que decidir: solo se mira el
+        // encabezado, y solo si el estado cambió desde la última vez
+        if (!sp->valid && (!versioned || !looked || sync_state_version(gx) != seen)) {
+            spec_peek_t pk;
+            spec_peek(&pk, myi);
+            looked = true;
+            seen = pk.ver;
+            if (pk.finished) return -1;
+            if (pk.moves == sent) {
+                unsigned int total = (unsigned int)gs->width * (unsigned int)gs->height;
+                if (*strat != STRAT_SEARCH && should_switch_to_endgame(pk.free_cells, total))
+                    *strat = STRAT_ENDGAME_HARVEST; // una vez activado, queda
+                unsigned ver;
+                sp->dir = decide_on_copy(*strat, myi, &ver);
+                if (snap->finished) return -1;
+                spec_fingerprint(&sp->fp, snap, myi);
+                sp->ver = ver;
+                sp->valid = true;
+            }
+        }
+        int r = sync_wait_my_turn_for(gx, myi, sp->valid ? -1 : SPEC_POLL_MS);
+        if (r != 1) return r == 0 ? 0 : -1;   // sin especulación válida se decide en el momento
+    }
+}
+
+static void spec_peek(spec_peek_t *pk, int myi) {
+    const player_t *me = &gs->players[myi];
+    if (gx->sync_mode == SYNC_SEQLOCK) {
+        do {
+            pk->ver = sync_read_begin(gx);
+            pk->finished = gs->finished;
+            pk->moves = me->valid_moves + me->invalid_moves;
+            pk->free_cells = gs_count_free_cells(gs);
+        } while (sync_read_retry(gx, pk->ver));
+        return;
+    }
+    reader_enter(gx);
+    gs_ro_refresh(gs);
+    pk->ver = sync_state_version(gx);
+    pk->finished = gs->finished;
+    pk->moves = me->valid_moves + me->invalid_moves;
+    pk->free_cells = gs_count_free_cells(gs);
+    reader_exit(gx);
+}
+
+// Si el máster no escribió desde la última validación (misma versión) la especulación sigue
+// valiendo sin tocar el estado. Si no, relee solo la huella (lock de lector corto / lectura
+// optimista en SEQLOCK) y, si coincide, anota la versión nueva.
+static bool spec_still_valid(spec_t *sp, int myi, bool *finished) {
+    *finished = false;
+    if (sp->valid && versioned && sync_state_version(gx) == sp->ver) return true;
+    spec_fp_t now;
+    unsigned ver;
+    if (gx->sync_mode == SYNC_SEQLOCK) {
+        do {
+            ver = sync_read_begin(gx);
+            *finished = gs->finished;
+            spec_fingerprint(&now, gs, myi);
+        } while (sync_read_retry(gx, ver));
+    } else {
+        reader_enter(gx);
+        gs_ro_refresh(gs);
+        ver = sync_state_version(gx);
+        *finished = gs->finished;
+        spec_fingerprint(&now, gs, myi);
+        reader_exit(gx);
+    }
+    if (!sp->valid || *finished || memcmp(&sp->fp, &now, sizeof now) != 0) return false;
+    sp->ver = ver;
+    return true;
+}
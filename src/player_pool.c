@@ -0,0 +1,108 @@
+#define _DEFAULT_SOURCE
+#include "player_pool.h"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <stdint.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+
+/* futex compartido entre procesos (sin FUTEX_PRIVATE_FLAG) */
+static int futex_wait(atomic_uint *addr, unsigned expected, const struct timespec *rel){
+    return (int)syscall(SYS_futex, (uint32_t *)addr, FUTEX_WAIT, expected, rel, NULL, 0);
+}
+
+static void futex_wake_all(atomic_uint *addr){
+    (void)syscall(SYS_futex, (uint32_t *)addr, FUTEX_WAKE, INT32_MAX, NULL, NULL, 0);
+}
+
+int pool_create(player_pool_t **out, size_t *bytes, const char *name, unsigned nslots){
+    size_t n = sizeof(player_pool_t) + (size_t)nslots * sizeof(pool_slot_t);
+    shm_unlink(name);
+    int fd = shm_open(name, O_CREAT|O_EXCL|O_RDWR, 0600);
+    if (fd == -1) return -1;
+    if (ftruncate(fd, (off_t)n) == -1) { int e = errno; close(fd); shm_unlink(name); errno = e; return -1; }
+    player_pool_t *p = mmap(NULL, n, PROT_READ|PROT_WRITE, MAP_SHARED, fd, 0);
+    int e = errno;
+    close(fd);
+    if (p == MAP_FAILED) { shm_unlink(name); errno = e; return -1; }
+    // ftruncate deja todo en cero: seq = done = 0, sin avisos pendientes
+    p->nslots = nslots;
+    *out = p;
+    *bytes = n;
+    return 0;
+}
+
+int pool_open(player_pool_t **out, size_t *bytes, const char *name){
+    int fd = shm_open(name, O_RDWR, 0);
+    if (fd == -1) return -1;
+    struct stat st;
+    if (fstat(fd, &st) == -1) { int e = errno; close(fd); errno = e; return -1; }
+    size_t n = (size_t)st.st_size;
+    if (n < sizeof(player_pool_t)) { close(fd); errno = EINVAL; return -1; }
+    player_pool_t *p = mmap(NULL, n, PROT_READ|PROT_WRITE, MAP_SHARED, fd, 0);
+    int e = errno;
+    close(fd);
+    if (p == MAP_FAILED) { errno = e; return -1; }
+    if (n < sizeof(player_pool_t) + (size_t)p->nslots * sizeof(pool_slot_t)) {
+        munmap(p, n);
+        errno = EINVAL;
+        return -1;
+    }
+    *out = p;
+    *bytes = n;
+    return 0;
+}
+
+void pool_close(player_pool_t *p, size_t bytes){
+    if (p) munmap(p, bytes);
+}
+
+unsigned pool_post(pool_slot_t *s, unsigned cmd, const char *ns, int index){
+    memset(s->ns, 0, sizeof s->ns);
+    if (ns) strncpy(s->ns, ns, sizeof s->ns - 1);
+    s->index = index;
+    atomic_store_explicit(&s->cmd, cmd, memory_order_relaxed);
+    // release: ns/index/cmd quedan visibles antes que el nuevo seq
+    unsigned seq = atomic_fetch_add_explicit(&s->seq, 1u, memory_order_release) + 1u;
+    futex_wake_all(&s->seq);
+    return seq;
+}
+
+int pool_wait_done(pool_slot_t *s, unsigned seq, int timeout_ms){
+    struct timespec t0;
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    for (;;) {
+        unsigned d = atomic_load_explicit(&s->done, memory_order_acquire);
+        if (d == seq) return 0;
+        struct timespec rel = { 0, 0 }, *relp = NULL;
+        if (timeout_ms >= 0) {
+            struct timespec now;
+            clock_gettime(CLOCK_MONOTONIC, &now);
+            long long left = (long long)timeout_ms * 1000000LL -
+                             ((now.tv_sec - t0.tv_sec) * 1000000000LL + (now.tv_nsec - t0.tv_nsec));
+            if (left <= 0) return -1;
+            rel.tv_sec = (time_t)(left / 1000000000LL);
+            rel.tv_nsec = (long)(left % 1000000000LL);
+            relp = &rel;
+        }
+        futex_wait(&s->done, d, relp);   // EAGAIN/EINTR/ETIMEDOUT: se revisa arriba
+    }
+}
+
+unsigned pool_wait(pool_slot_t *s, unsigned seen){
+    for (;;) {
+        unsigned q = atomic_load_explicit(&s->seq, memory_order_acquire);
+        if (q != seen) return q;
+        futex_wait(&s->seq, q, NULL);
+    }
+}
+
+void pool_done(pool_slot_t *s, unsigned seq){
+    atomic_store_explicit(&s->done, seq, memory_order_release);
+    futex_wake_all(&s->done);
+}
@@ -1,3 +1,4 @@
+#define _DEFAULT_SOURCE
 #include <stdlib.h>
 #include <limits.h>
 #include <time.h>
@@ -5,54 +6,53 @@
 #include "player_strategies.h"
 #include "game_utils.h"
 #include "shared_mem.h"
+#include "bitboard.h"
+#include "search.h"
+#include "territory.h"
 
 // ----------------- helpers comunes -----------------
-static inline bool valid_dest(const game_state_t *gs, int nx, int ny) {
-    return in_bounds_wh(nx, ny, gs->width, gs->height) &&
-           gs->board[idx_wh(nx, ny, gs->width)] > 0;
+// Contexto de una decisión: la ventana 7x7 de libres alrededor del jugador cubre
+// los anillos 1 y 2 de cada candidata, así que casi todo sale de popcounts sobre ella.
+typedef struct {
+    const game_state_t *gs;
+    gs_cells_t b;           // vista del tablero (bitmap + valores)
+    int x, y;               // posición del jugador
+    uint64_t patch;         // bb_patch7 centrada en (x,y)
+    unsigned *rng;          // semilla de los desempates al azar (NULL = rand() global)
+} sctx_t;
+
+static inline bool valid_dest(const sctx_t *s, int d) {
+    return (s->patch & BB_P(DX[d], DY[d])) != 0;
 }
 
-static inline int mobility_from(const game_state_t *gs, int x, int y) {
-    int m = 0;
-    for (int d = 0; d < 8; ++d) {
-        int nx = x + DX[d], ny = y + DY[d];
-        if (valid_dest(gs, nx, ny)) m++;
-    }
-    return m;
-}
-
-// Cuánta “libertad” hay si me muevo a (nx,ny): anillo 1 y 2
-static int space_2rings(const game_state_t *gs, int nx, int ny) {
-    static const int R2DX[16] = { 0,1,2,2,2,1,0,-1,-2,-2,-2,-1,0,1, 0,-1 };
-    static const int R2DY[16] = {-2,-2,-2,-1,0,1,2,2, 2, 1, 0,-1,0,1,-2,-1 };
-    int sc = 0;
-    // anillo 1
-    sc += mobility_from(gs, nx, ny) * 3;
-    // anillo 2 (mide “aire” alrededor)
-    for (int i = 0; i < 16; ++i) {
-        int ax = nx + R2DX[i], ay = ny + R2DY[i];
-        if (in_bounds_wh(ax, ay, gs->width, gs->height) &&
-            gs->board[idx_wh(ax, ay, gs->width)] > 0) sc++;
-    }
-    return sc;
+// Vecinos libres de la candidata d
+static inline int mobility_from(const sctx_t *s, int d) {
+    return bb_count(s->patch, BB_RING1, DX[d], DY[d]);
 }
 
-static inline int cell_value(const game_state_t *gs, int x, int y) {
-    return gs->board[idx_wh(x, y, gs->width)];
+// Cuánta “libertad” hay si me muevo en d: anillo 1 (x3) y anillo 2 (borde 5x5)
+static int space_2rings(const sctx_t *s, int d) {
+    return mobility_from(s, d) * 3 + bb_count(s->patch, BB_RING2, DX[d], DY[d]);
 }
 
-static int center_bias(const game_state_t *gs, int x, int y) {
+static inline int cell_value(const sctx_t *s, int d) {
+    return gs_cell_value(&s->b, s->x + DX[d], s->y + DY[d]);
+}
+
+static int center_bias(const sctx_t *s, int d) {
     // Penaliza distancia al centro (cuanto más cerca, mejor)
-    double cx = (gs->width  - 1) / 2.0;
-    double cy = (gs->height - 1) / 2.0;
-    double dx = x - cx, dy = y - cy;
+    double cx = (s->b.W - 1) / 2.0;
+    double cy = (s->b.H - 1) / 2.0;
+    double dx = s->x + DX[d] - cx, dy = s->y + DY[d] - cy;
     double dist2 = dx*dx + dy*dy;
     // Escala a entero con signo negativo (menor dist -> mayor puntaje)
     return (int)(-dist2);
 }
 
-static int cutoff_score(const game_state_t *gs, int me, int nx, int ny) {
+static int cutoff_score(const sctx_t *s, int me, int d) {
     // Heurística simple: restar la movilidad promedio de rivales cercanos
+    const game_state_t *gs = s->gs;
+    int nx = s->x + DX[d], ny = s->y + DY[d];
     int impact = 0, cnt = 0;
     for (unsigned p = 0; p < gs->num_players; ++p) {
         if ((int)p == me) continue;
@@ -61,7 +61,7 @@ static int cutoff_score(const game_state_t *gs, int me, int nx, int ny) {
         int dx = (int)op->x - nx, dy = (int)op->y - ny;
         int r2 = dx*dx + dy*dy;
         if (r2 <= 10) { // solo rivales “cercanos”
-            impact += mobility_from(gs, op->x, op->y);
+            impact += bb_mobility_at(&s->b, op->x, op->y);
             cnt++;
         }
     }
@@ -70,117 +70,203 @@ static int cutoff_score(const game_state_t *gs, int me, int nx, int ny) {
 }
 
 // 2-ply liviano: evalúa 8 jugadas, para cada una calcula mi movilidad resultante
-static int two_ply_light_score(const game_state_t *gs, int nx, int ny) {
-    return mobility_from(gs, nx, ny) * 5 + cell_value(gs, nx, ny);
+static int two_ply_light_score(const sctx_t *s, int d) {
+    return mobility_from(s, d) * 5 + cell_value(s, d);
+}
+
+static inline int coin(const sctx_t *s) {
+    return (s->rng ? rand_r(s->rng) : rand()) & 1;
 }
 
 // ----------------- selección por estrategia -----------------
-static unsigned char best_dir_greedy_plus(const game_state_t *gs, int x, int y, bool rnd_tiebreak) {
+static unsigned char best_dir_greedy_plus(const sctx_t *s, bool rnd_tiebreak) {
     int best = INT_MIN, bestd = -1;
 
     for (int d = 0; d < 8; ++d) {
-        int nx = x + DX[d], ny = y + DY[d];
-        if (!valid_dest(gs, nx, ny)) continue;
+        if (!valid_dest(s, d)) continue;
 
-        int sc = cell_value(gs, nx, ny) * 10 + mobility_from(gs, nx, ny);
-        if (sc > best || (rnd_tiebreak && sc == best && (rand() & 1))) {
+        int sc = cell_value(s, d) * 10 + mobility_from(s, d);
+        if (sc > best || (rnd_tiebreak && sc == best && coin(s))) {
             best = sc; bestd = d;
         }
     }
     return (bestd < 0) ? 255 : (unsigned char)bestd;
 }
 
-static unsigned char best_dir_space_max(const game_state_t *gs, int me, int x, int y) {
+static unsigned char best_dir_space_max(const sctx_t *s, int me) {
     (void)me;
     int best = INT_MIN, bestd = -1;
     for (int d = 0; d < 8; ++d) {
-        int nx = x + DX[d], ny = y + DY[d];
-        if (!valid_dest(gs, nx, ny)) continue;
-        int sc = space_2rings(gs, nx, ny);
+        if (!valid_dest(s, d)) continue;
+        int sc = space_2rings(s, d);
         if (sc > best) { best = sc; bestd = d; }
     }
     return (bestd < 0) ? 255 : (unsigned char)bestd;
 }
 
-static unsigned char best_dir_center_control(const game_state_t *gs, int me, int x, int y) {
+static unsigned char best_dir_center_control(const sctx_t *s, int me) {
     (void)me;
     int best = INT_MIN, bestd = -1;
     for (int d = 0; d < 8; ++d) {
-        int nx = x + DX[d], ny = y + DY[d];
-        if (!valid_dest(gs, nx, ny)) continue;
-        int sc = cell_value(gs, nx, ny) * 6 + center_bias(gs, nx, ny);
+        if (!valid_dest(s, d)) continue;
+        int sc = cell_value(s, d) * 6 + center_bias(s, d);
         if (sc > best) { best = sc; bestd = d; }
     }
     return (bestd < 0) ? 255 : (unsigned char)bestd;
 }
 
-static unsigned char best_dir_cutoff(const game_state_t *gs, int me, int x, int y) {
+static unsigned char best_dir_cutoff(const sctx_t *s, int me) {
     int best = INT_MIN, bestd = -1;
     for (int d = 0; d < 8; ++d) {
-        int nx = x + DX[d], ny = y + DY[d];
-        if (!valid_dest(gs, nx, ny)) continue;
-        int sc = cell_value(gs, nx, ny) * 5 + cutoff_score(gs, me, nx, ny);
+        if (!valid_dest(s, d)) continue;
+        int sc = cell_value(s, d) * 5 + cutoff_score(s, me, d);
         if (sc > best) { best = sc; bestd = d; }
     }
     return (bestd < 0) ? 255 : (unsigned char)bestd;
 }
 
-static unsigned char best_dir_two_ply_light(const game_state_t *gs, int me, int x, int y) {
+static unsigned char best_dir_two_ply_light(const sctx_t *s, int me) {
     (void)me;
     int best = INT_MIN, bestd = -1;
     for (int d = 0; d < 8; ++d) {
-        int nx = x + DX[d], ny = y + DY[d];
-        if (!valid_dest(gs, nx, ny)) continue;
-        int sc = two_ply_light_score(gs, nx, ny);
+        if (!valid_dest(s, d)) continue;
+        int sc = two_ply_light_score(s, d);
         if (sc > best) { best = sc; bestd = d; }
     }
     return (bestd < 0) ? 255 : (unsigned char)bestd;
 }
 
-static unsigned char best_dir_endgame_harvest(const game_state_t *gs, int me, int x, int y) {
+static unsigned char best_dir_endgame_harvest(const sctx_t *s, int me) {
     (void)me;
     int best = INT_MIN, bestd = -1;
     for (int d = 0; d < 8; ++d) {
-        int nx = x + DX[d], ny = y + DY[d];
-        if (!valid_dest(gs, nx, ny)) continue;
+        if (!valid_dest(s, d)) continue;
         // endgame: prioridad altísima al valor de celda, leve preferencia a movilidad
-        int sc = cell_value(gs, nx, ny) * 20 + mobility_from(gs, nx, ny);
+        int sc = cell_value(s, d) * 20 + mobility_from(s, d);
+        if (sc > best) { best = sc; bestd = d; }
+    }
+    return (bestd < 0) ? 255 : (unsigned char)bestd;
+}
+
+// Voronoi con la candidata como fuente propia y las cabezas de los rivales activos: cuánto
+// territorio (suma de recompensas) me queda por encima del mejor rival si voy a d.
+static unsigned char best_dir_territory(const sctx_t *s, int me) {
+    const game_state_t *gs = s->gs;
+    terr_win_t w;
+    terr_win_load(&w, &s->b, s->x, s->y);
+
+    int sx[TERR_NP], sy[TERR_NP], n = 1;
+    for (unsigned p = 0; p < gs->num_players && n < TERR_NP; ++p) {
+        if ((int)p == me || gs->players[p].blocked) continue;
+        sx[n] = (int)gs->players[p].x;
+        sy[n] = (int)gs->players[p].y;
+        n++;
+    }
+
+    int best = INT_MIN, bestd = -1;
+    for (int d = 0; d < 8; ++d) {
+        if (!valid_dest(s, d)) continue;
+        sx[0] = s->x + DX[d];
+        sy[0] = s->y + DY[d];
+        terr_count_t t;
+        terr_voronoi(&w, sx, sy, n, &t);
+        int rival = 0;
+        for (int k = 1; k < n; ++k)
+            if ((int)t.value[k] > rival) rival = (int)t.value[k];
+        int sc = ((int)t.value[0] - rival) * 4 + cell_value(s, d) * 8 + mobility_from(s, d);
         if (sc > best) { best = sc; bestd = d; }
     }
     return (bestd < 0) ? 255 : (unsigned char)bestd;
 }
 
 // ----------------- API -----------------
+static const char *const STRAT_NAMES[STRAT_COUNT] = {
+    [STRAT_GREEDY_PLUS]     = "greedy",
+    [STRAT_SPACE_MAX]       = "space",
+    [STRAT_CENTER_CONTROL]  = "center",
+    [STRAT_CUTOFF]          = "cutoff",
+    [STRAT_TWO_PLY_LIGHT]   = "twoply",
+    [STRAT_ENDGAME_HARVEST] = "harvest",
+    [STRAT_RANDOM_TIEBREAK] = "random",
+    [STRAT_SEARCH]          = "search",
+    [STRAT_TERRITORY]       = "territory",
+};
+
+static search_limits_t g_search_limits = { SEARCH_DEFAULT_BUDGET_MS * 1000u, 0 };
+static search_pool_t *g_search_pool = NULL;   // NULL => search secuencial
+
+void strategy_set_search_limits(unsigned budget_ms, int max_depth) {
+    g_search_limits.budget_us = budget_ms * 1000u;
+    g_search_limits.max_depth = max_depth;
+}
+
+int strategy_set_search_threads(int nthreads) {
+    if (nthreads <= 1 && !g_search_pool) return 1;   // un hilo: search_pick directo, sin pool
+    if (!g_search_pool) g_search_pool = search_pool_create(nthreads);
+    return g_search_pool ? search_pool_threads(g_search_pool) : 1;
+}
+
+const char *strategy_name(strategy_t strat) {
+    if ((int)strat < 0 || strat >= STRAT_COUNT) return "?";
+    return STRAT_NAMES[strat];
+}
+
+int strategy_from_name(const char *name, strategy_t *out) {
+    if (!name || !out) return -1;
+    for (int s = 0; s < STRAT_COUNT; ++s) {
+        if (strcmp(name, STRAT_NAMES[s]) == 0) { *out = (strategy_t)s; return 0; }
+    }
+    return -1;
+}
+
 strategy_t choose_strategy(unsigned short W, unsigned short H,
                            unsigned int num_players, int myi)
 {
     (void)myi;
     // Heurística simple por forma del tablero y cantidad de jugadores
-    if (W*H >= 120 && num_players >= 3) return STRAT_SPACE_MAX;
-    if (W >= H*2 || H >= W*2)           return STRAT_CENTER_CONTROL; // tableros “alargados”
+    unsigned long cells = (unsigned long)W * H;
+    if (cells >= 120 && num_players >= 3) return STRAT_SPACE_MAX;
+    if ((unsigned)W >= H*2u || (unsigned)H >= W*2u) return STRAT_CENTER_CONTROL; // tableros “alargados”
     if (num_players == 2)               return STRAT_TWO_PLY_LIGHT;  // 1v1 más “táctico”
     return STRAT_GREEDY_PLUS;
 }
 
+int strategy_rows(strategy_t strat, unsigned short H) {
+    switch (strat) {
+        case STRAT_SEARCH:    return -1;
+        case STRAT_TERRITORY: return H <= TERR_SIDE ? -1 : TERR_RADIUS;   // ventana del flood fill
+        default:              return 5;   // bb_patch7 de las candidatas y rivales cercanos
+    }
+}
+
 bool should_switch_to_endgame(unsigned int free_cells, unsigned int total_cells) {
     // Cambiar a endgame cuando queda <=15% de libres
-    return free_cells * 100u <= total_cells * 15u;
+    return (unsigned long long)free_cells * 100u <= (unsigned long long)total_cells * 15u;
 }
 
 unsigned char pick_move_strategy(strategy_t strat, const game_state_t *gs, int player_idx){
+    return pick_move_strategy_r(strat, gs, player_idx, NULL);
+}
+
+unsigned char pick_move_strategy_r(strategy_t strat, const game_state_t *gs, int player_idx, unsigned *rng){
     const player_t *me = &gs->players[player_idx];
     if (me->blocked) return 255;
 
-    int x = (int)me->x, y = (int)me->y;
+    sctx_t s = { .gs = gs, .x = (int)me->x, .y = (int)me->y, .rng = rng };
+    gs_cells_bind(&s.b, gs);
+    s.patch = bb_patch7(&s.b, s.x, s.y);
+    if (!(s.patch & BB_RING1)) return 255; // sin vecinos libres
 
     switch (strat) {
-        case STRAT_GREEDY_PLUS:     return best_dir_greedy_plus(gs, x, y, false);
-        case STRAT_RANDOM_TIEBREAK: return best_dir_greedy_plus(gs, x, y, true);
-        case STRAT_SPACE_MAX:       return best_dir_space_max(gs, player_idx, x, y);
-        case STRAT_CENTER_CONTROL:  return best_dir_center_control(gs, player_idx, x, y);
-        case STRAT_CUTOFF:          return best_dir_cutoff(gs, player_idx, x, y);
-        case STRAT_TWO_PLY_LIGHT:   return best_dir_two_ply_light(gs, player_idx, x, y);
-        case STRAT_ENDGAME_HARVEST: return best_dir_endgame_harvest(gs, player_idx, x, y);
+        case STRAT_GREEDY_PLUS:     return best_dir_greedy_plus(&s, false);
+        case STRAT_RANDOM_TIEBREAK: return best_dir_greedy_plus(&s, true);
+        case STRAT_SPACE_MAX:       return best_dir_space_max(&s, player_idx);
+        case STRAT_CENTER_CONTROL:  return best_dir_center_control(&s, player_idx);
+        case STRAT_CUTOFF:          return best_dir_cutoff(&s, player_idx);
+        case STRAT_TWO_PLY_LIGHT:   return best_dir_two_ply_light(&s, player_idx);
+        case STRAT_ENDGAME_HARVEST: return best_dir_endgame_harvest(&s, player_idx);
+        case STRAT_SEARCH:          return search_pick_parallel(g_search_pool, gs, player_idx, &g_search_limits);
+        case STRAT_TERRITORY:       return best_dir_territory(&s, player_idx);
         default:                    return 255;
     }
 }
@@ -0,0 +1,475 @@
+#define _DEFAULT_SOURCE
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <limits.h>
+#include <time.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include "search.h"
+#include "bitboard.h"     // bb_patch7, bb_mobility_at, BB_P
+#include "game_utils.h"   // DX/DY
+
+#define NP        9                 /* jugadores máximos (players[9]) */
+#define TT_BITS   16
+#define TT_SIZE   (1u << TT_BITS)
+#define CHECK_EVERY 255u            /* cada cuántos nodos se mira el reloj */
+
+enum { TT_EXACT = 1, TT_LOWER, TT_UPPER };
+
+typedef struct {
+    uint64_t key;
+    int32_t  value;
+    int16_t  depth;
+    uint8_t  flag;
+    uint8_t  best;                  /* dir 0..7 o 255 */
+} tt_entry_t;
+
+typedef struct {
+    /* tablero privado: copia del bitmap de libres, valores leídos del estado */
+    uint64_t *bits;
+    size_t bits_cap;                /* palabras reservadas */
+    gs_cells_t b;                   /* vista con b.bits -> copia privada */
+
+    /* jugadores */
+    int n, me;
+    int px[NP], py[NP];
+    int gain[NP];                   /* recompensa sumada dentro de la búsqueda */
+    unsigned base[NP];              /* puntaje real al empezar */
+    bool active[NP];                /* no bloqueado al empezar */
+
+    /* Zobrist */
+    uint64_t key, salt;
+    unsigned long job;              /* decisión paralela cargada (0 = ninguna) */
+
+    /* reloj */
+    struct timespec t0;
+    unsigned budget_us;
+    unsigned long nodes, tt_hits;
+    bool can_abort, aborted;
+
+    search_stats_t last;
+    tt_entry_t tt[TT_SIZE];
+} search_ctx_t;
+
+static _Thread_local search_ctx_t *tls_ctx = NULL;
+
+/* ===== utilitarias ===== */
+
+static inline uint64_t mix64(uint64_t x){
+    x += 0x9e3779b97f4a7c15ull;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ull;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebull;
+    return x ^ (x >> 31);
+}
+static inline uint64_t z_cell(size_t idx)          { return mix64((uint64_t)idx * 2u + 1u); }
+static inline uint64_t z_pos(int p, size_t idx)    { return mix64(((uint64_t)idx << 4 | (unsigned)p) ^ 0x5a5a5a5aull); }
+static inline uint64_t z_turn(int p)               { return mix64(0xabcdef00ull + (unsigned)p); }
+
+static unsigned us_since(const struct timespec *t0){
+    struct timespec now; clock_gettime(CLOCK_MONOTONIC, &now);
+    return (unsigned)((now.tv_sec - t0->tv_sec) * 1000000L + (now.tv_nsec - t0->tv_nsec) / 1000L);
+}
+
+static unsigned elapsed_us(const search_ctx_t *c){
+    return us_since(&c->t0);
+}
+
+static inline void bit_flip(search_ctx_t *c, int x, int y){
+    unsigned bx = (unsigned)(x + GS_BITS_PAD);
+    c->bits[(size_t)(y + GS_BITS_PAD) * c->b.stride + (bx >> 6)] ^= 1ull << (bx & 63u);
+}
+
+static inline size_t cell_idx(const search_ctx_t *c, int x, int y){
+    return (size_t)y * (size_t)c->b.W + (size_t)x;
+}
+
+static int next_player(const search_ctx_t *c, int p){
+    for (int k = 1; k <= c->n; ++k) {
+        int q = (p + k) % c->n;
+        if (c->active[q]) return q;
+    }
+    return p;
+}
+
+/* ===== evaluación (desde el punto de vista de me) ===== */
+
+static int evaluate(const search_ctx_t *c){
+    int mine = (int)c->base[c->me] + c->gain[c->me];
+    int opp = INT_MIN;
+    for (int p = 0; p < c->n; ++p) {
+        if (p == c->me || !c->active[p]) continue;
+        int s = (int)c->base[p] + c->gain[p];
+        if (s > opp) opp = s;
+    }
+    if (opp == INT_MIN) opp = 0;
+    int mob = bb_mobility_at(&c->b, c->px[c->me], c->py[c->me]);
+    return 4 * (mine - opp) + 3 * mob - (mob == 0 ? 200 : 0);
+}
+
+/* ===== alpha-beta paranoica ===== */
+
+static int ab(search_ctx_t *c, int depth, int alpha, int beta, int p, unsigned char *best_out){
+    if ((++c->nodes & CHECK_EVERY) == 0 && c->can_abort && elapsed_us(c) >= c->budget_us) c->aborted = true;
+    if (c->aborted) return 0;
+    if (depth == 0) return evaluate(c);
+
+    uint64_t k = c->key ^ z_turn(p);
+    tt_entry_t *e = &c->tt[k & (TT_SIZE - 1)];
+    unsigned char tt_best = 255;
+    if (e->key == k) {
+        tt_best = e->best;
+        if (e->depth >= depth && !best_out) {
+            int v = e->value;
+            if (e->flag == TT_EXACT) { c->tt_hits++; return v; }
+            if (e->flag == TT_LOWER && v > alpha) alpha = v;
+            if (e->flag == TT_UPPER && v < beta)  beta = v;
+            if (alpha >= beta) { c->tt_hits++; return v; }
+        }
+    }
+
+    // jugadas: ventana 7x7, ordenadas por valor de celda (la de la tabla primero)
+    int x = c->px[p], y = c->py[p];
+    uint64_t patch = bb_patch7(&c->b, x, y);
+    unsigned char dirs[8]; int vals[8], nm = 0;
+    for (int d = 0; d < 8; ++d) {
+        if (!(patch & BB_P(DX[d], DY[d]))) continue;
+        int v = gs_cell_value(&c->b, x + DX[d], y + DY[d]) + (d == tt_best ? 100 : 0);
+        int j = nm++;
+        while (j > 0 && vals[j - 1] < v) { dirs[j] = dirs[j - 1]; vals[j] = vals[j - 1]; --j; }
+        dirs[j] = (unsigned char)d; vals[j] = v;
+    }
+
+    int next = next_player(c, p);
+    if (nm == 0) {
+        // sin jugadas: para mí es terminal; el rival pierde el turno
+        if (p == c->me) return evaluate(c);
+        return ab(c, depth - 1, alpha, beta, next, NULL);
+    }
+
+    bool maxing = (p == c->me);
+    int a0 = alpha, b0 = beta;
+    int best = maxing ? INT_MIN : INT_MAX;
+    unsigned char bestd = dirs[0];
+    for (int m = 0; m < nm; ++m) {
+        int d = dirs[m];
+        int nx = x + DX[d], ny = y + DY[d];
+        size_t from = cell_idx(c, x, y), to = cell_idx(c, nx, ny);
+        int v = gs_cell_value(&c->b, nx, ny);
+
+        // make
+        bit_flip(c, nx, ny);
+        c->px[p] = nx; c->py[p] = ny; c->gain[p] += v;
+        c->key ^= z_cell(to) ^ z_pos(p, from) ^ z_pos(p, to);
+
+        int sc = ab(c, depth - 1, alpha, beta, next, NULL);
+
+        // unmake
+        c->key ^= z_cell(to) ^ z_pos(p, from) ^ z_pos(p, to);
+        c->px[p] = x; c->py[p] = y; c->gain[p] -= v;
+        bit_flip(c, nx, ny);
+
+        if (c->aborted) return 0;
+        if (maxing ? sc > best : sc < best) { best = sc; bestd = (unsigned char)d; }
+        if (maxing) { if (best > alpha) alpha = best; }
+        else        { if (best < beta)  beta = best; }
+        if (alpha >= beta) break;
+    }
+
+    e->key = k;
+    e->value = best;
+    e->depth = (int16_t)depth;
+    e->best = bestd;
+    e->flag = best <= a0 ? TT_UPPER : best >= b0 ? TT_LOWER : TT_EXACT;
+    if (best_out) *best_out = bestd;
+    return best;
+}
+
+/* ===== API ===== */
+
+static search_ctx_t *ctx_get(size_t words){
+    if (!tls_ctx) {
+        tls_ctx = calloc(1, sizeof *tls_ctx);
+        if (!tls_ctx) return NULL;
+    }
+    if (tls_ctx->bits_cap < words) {
+        uint64_t *nb = realloc(tls_ctx->bits, words * sizeof(uint64_t));
+        if (!nb) return NULL;
+        tls_ctx->bits = nb;
+        tls_ctx->bits_cap = words;
+    }
+    return tls_ctx;
+}
+
+/* Contexto del hilo cargado con gs (tablero privado, jugadores) y sal nueva; NULL sin memoria. */
+static search_ctx_t *ctx_load(const game_state_t *gs, int me){
+    gs_cells_t src; gs_cells_bind(&src, gs);
+    size_t words = (size_t)(src.H + 2 * GS_BITS_PAD) * src.stride;
+    search_ctx_t *c = ctx_get(words);
+    if (!c) return NULL;
+
+    memcpy(c->bits, src.bits, words * sizeof(uint64_t));
+    c->b = src;
+    c->b.bits = c->bits;
+
+    c->n = (int)(gs->num_players > NP ? NP : gs->num_players);
+    c->me = me;
+    for (int p = 0; p < c->n; ++p) {
+        c->px[p] = gs->players[p].x; c->py[p] = gs->players[p].y;
+        c->gain[p] = 0;
+        c->base[p] = gs->players[p].score;
+        c->active[p] = !gs->players[p].blocked;
+    }
+    // sal nueva por decisión: las entradas viejas de la tabla no matchean
+    c->salt = mix64(c->salt + 1u);
+    c->key = c->salt;
+    for (int p = 0; p < c->n; ++p) c->key ^= z_pos(p, cell_idx(c, c->px[p], c->py[p]));
+    c->nodes = c->tt_hits = 0;
+    c->job = 0;
+    return c;
+}
+
+unsigned char search_pick(const game_state_t *gs, int me, const search_limits_t *lim){
+    if (gs->players[me].blocked) return 255;
+    search_ctx_t *c = ctx_load(gs, me);
+    if (!c) return 255;
+    clock_gettime(CLOCK_MONOTONIC, &c->t0);
+
+    c->budget_us = lim ? lim->budget_us : SEARCH_DEFAULT_BUDGET_MS * 1000u;
+    int max_depth = lim && lim->max_depth > 0 ? lim->max_depth : SEARCH_MAX_DEPTH;
+    if (max_depth > SEARCH_MAX_DEPTH) max_depth = SEARCH_MAX_DEPTH;
+
+    unsigned char best = 255;
+    int done = 0;
+    for (int depth = 1; depth <= max_depth; ++depth) {
+        unsigned char d = 255;
+        c->can_abort = depth > 1 && c->budget_us > 0;   // la profundidad 1 siempre termina
+        c->aborted = false;
+        ab(c, depth, INT_MIN, INT_MAX, me, &d);
+        if (c->aborted) break;
+        best = d; done = depth;
+        // otra iteración cuesta varias veces la anterior: no empezarla si no entra
+        if (c->budget_us > 0 && elapsed_us(c) * 3u >= c->budget_us) break;
+    }
+
+    c->last.depth = done;
+    c->last.nodes = c->nodes;
+    c->last.tt_hits = c->tt_hits;
+    c->last.elapsed_us = elapsed_us(c);
+    return best;
+}
+
+search_stats_t search_last_stats(void){
+    search_stats_t z = {0, 0, 0, 0};
+    return tls_ctx ? tls_ctx->last : z;
+}
+
+void search_release(void){
+    if (!tls_ctx) return;
+    free(tls_ctx->bits);
+    free(tls_ctx);
+    tls_ctx = NULL;
+}
+
+/* ===== Búsqueda paralela por jugada raíz ===== */
+
+typedef struct {
+    const game_state_t *gs;
+    unsigned long id;               /* decisión: cada hilo carga su contexto una vez por id */
+    int me, depth, nm;
+    unsigned char dirs[8];          /* jugadas raíz, en el orden de ab */
+    struct timespec t0;
+    unsigned budget_us;
+    /* resultado por jugada raíz (cada una la escribe un único hilo) */
+    int alpha;                      /* hermanos: ventana (alpha, +inf) con alpha = valor de la primera */
+    int value[8];
+    bool aborted[8];
+    unsigned long nodes[8], tt_hits[8];
+} root_job_t;
+
+struct search_pool {
+    int nthreads;                   /* contando al llamador */
+    pthread_t th[SEARCH_MAX_THREADS];
+    pthread_mutex_t mu;
+    pthread_cond_t go, idle;
+    unsigned gen;                   /* cambia con cada iteración publicada */
+    int busy;                       /* ayudantes que no terminaron la iteración */
+    bool quit;
+    root_job_t *job;
+    atomic_int next;                /* próxima jugada raíz sin tomar */
+};
+
+static atomic_ulong next_job_id = 1;
+
+/* Valor de la jugada raíz m a profundidad job->depth: exacto para la primera; para las demás
+   exacto si supera a la primera (ventana (alpha, +inf)), si no una cota <= alpha. Cada hilo
+   carga el tablero y saca sal una sola vez por decisión: su tabla sigue valiendo entre jugadas
+   raíz e iteraciones de la profundización, como en search_pick. */
+static void root_eval(root_job_t *j, int m){
+    search_ctx_t *c = tls_ctx;
+    if (!c || c->job != j->id) {
+        c = ctx_load(j->gs, j->me);
+        if (!c) { j->aborted[m] = true; return; }
+        c->job = j->id;
+    }
+    unsigned long n0 = c->nodes, h0 = c->tt_hits;
+    c->t0 = j->t0;
+    c->budget_us = j->budget_us;
+    c->can_abort = j->depth > 1 && j->budget_us > 0;   // la profundidad 1 siempre termina
+    c->aborted = false;
+
+    // make de la jugada raíz (igual que en ab)
+    int me = j->me, d = j->dirs[m];
+    int x = c->px[me], y = c->py[me], nx = x + DX[d], ny = y + DY[d];
+    int v = gs_cell_value(&c->b, nx, ny);
+    bit_flip(c, nx, ny);
+    c->px[me] = nx; c->py[me] = ny; c->gain[me] += v;
+    c->key ^= z_cell(cell_idx(c, nx, ny)) ^ z_pos(me, cell_idx(c, x, y)) ^ z_pos(me, cell_idx(c, nx, ny));
+
+    j->value[m] = ab(c, j->depth - 1, m == 0 ? INT_MIN : j->alpha, INT_MAX, next_player(c, me), NULL);
+
+    // unmake: el contexto queda listo para la próxima jugada raíz
+    c->key ^= z_cell(cell_idx(c, nx, ny)) ^ z_pos(me, cell_idx(c, x, y)) ^ z_pos(me, cell_idx(c, nx, ny));
+    c->px[me] = x; c->py[me] = y; c->gain[me] -= v;
+    bit_flip(c, nx, ny);
+
+    j->aborted[m] = c->aborted;
+    j->nodes[m] = c->nodes - n0;
+    j->tt_hits[m] = c->tt_hits - h0;
+}
+
+static void drain_root(search_pool_t *p, root_job_t *j){
+    int m;
+    while ((m = atomic_fetch_add(&p->next, 1)) < j->nm) root_eval(j, m);
+}
+
+static void *pool_worker(void *arg){
+    search_pool_t *p = arg;
+    unsigned seen = 0;
+    pthread_mutex_lock(&p->mu);
+    for (;;) {
+        while (!p->quit && p->gen == seen) pthread_cond_wait(&p->go, &p->mu);
+        if (p->quit) break;
+        seen = p->gen;
+        root_job_t *j = p->job;
+        pthread_mutex_unlock(&p->mu);
+        drain_root(p, j);
+        pthread_mutex_lock(&p->mu);
+        if (--p->busy == 0) pthread_cond_signal(&p->idle);
+    }
+    pthread_mutex_unlock(&p->mu);
+    search_release();
+    return NULL;
+}
+
+/* Publica una iteración, trabaja en ella y espera a los ayudantes. */
+static void pool_run(search_pool_t *p, root_job_t *j){
+    atomic_store(&p->next, 1);   // la jugada 0 ya la evaluó el llamador
+    pthread_mutex_lock(&p->mu);
+    p->job = j;
+    p->gen++;
+    p->busy = p->nthreads - 1;
+    pthread_cond_broadcast(&p->go);
+    pthread_mutex_unlock(&p->mu);
+
+    drain_root(p, j);
+
+    pthread_mutex_lock(&p->mu);
+    while (p->busy > 0) pthread_cond_wait(&p->idle, &p->mu);
+    pthread_mutex_unlock(&p->mu);
+}
+
+search_pool_t *search_pool_create(int nthreads){
+    if (nthreads < 1) nthreads = 1;
+    if (nthreads > SEARCH_MAX_THREADS) nthreads = SEARCH_MAX_THREADS;
+    search_pool_t *p = calloc(1, sizeof *p);
+    if (!p) return NULL;
+    pthread_mutex_init(&p->mu, NULL);
+    pthread_cond_init(&p->go, NULL);
+    pthread_cond_init(&p->idle, NULL);
+    p->nthreads = 1;
+    for (int i = 1; i < nthreads; ++i) {
+        if (pthread_create(&p->th[i], NULL, pool_worker, p) != 0) break;
+        p->nthreads++;
+    }
+    return p;
+}
+
+void search_pool_destroy(search_pool_t *p){
+    if (!p) return;
+    pthread_mutex_lock(&p->mu);
+    p->quit = true;
+    pthread_cond_broadcast(&p->go);
+    pthread_mutex_unlock(&p->mu);
+    for (int i = 1; i < p->nthreads; ++i) pthread_join(p->th[i], NULL);
+    pthread_cond_destroy(&p->go);
+    pthread_cond_destroy(&p->idle);
+    pthread_mutex_destroy(&p->mu);
+    free(p);
+}
+
+int search_pool_threads(const search_pool_t *p){
+    return p ? p->nthreads : 0;
+}
+
+unsigned char search_pick_parallel(search_pool_t *p, const game_state_t *gs, int me, const search_limits_t *lim){
+    if (!p || p->nthreads <= 1) return search_pick(gs, me, lim);   // sin ayudantes: nada que repartir
+    if (gs->players[me].blocked) return 255;
+
+    root_job_t j;
+    memset(&j, 0, sizeof j);
+    j.gs = gs;
+    j.id = atomic_fetch_add(&next_job_id, 1);
+    j.me = me;
+    clock_gettime(CLOCK_MONOTONIC, &j.t0);
+    j.budget_us = lim ? lim->budget_us : SEARCH_DEFAULT_BUDGET_MS * 1000u;
+    int max_depth = lim && lim->max_depth > 0 ? lim->max_depth : SEARCH_MAX_DEPTH;
+    if (max_depth > SEARCH_MAX_DEPTH) max_depth = SEARCH_MAX_DEPTH;
+
+    // jugadas raíz ordenadas por valor de celda, como en ab (sin jugada de tabla)
+    gs_cells_t b; gs_cells_bind(&b, gs);
+    int x = gs->players[me].x, y = gs->players[me].y;
+    uint64_t patch = bb_patch7(&b, x, y);
+    int vals[8];
+    for (int d = 0; d < 8; ++d) {
+        if (!(patch & BB_P(DX[d], DY[d]))) continue;
+        int v = gs_cell_value(&b, x + DX[d], y + DY[d]);
+        int k = j.nm++;
+        while (k > 0 && vals[k - 1] < v) { j.dirs[k] = j.dirs[k - 1]; vals[k] = vals[k - 1]; --k; }
+        j.dirs[k] = (unsigned char)d; vals[k] = v;
+    }
+    if (j.nm == 0) return 255;
+
+    unsigned char best = 255;
+    int done = 0;
+    unsigned long nodes = 0, tt_hits = 0;
+    for (int depth = 1; depth <= max_depth; ++depth) {
+        j.depth = depth;
+        // primero la mejor candidata sola: su valor acota a las demás, que van en paralelo
+        root_eval(&j, 0);
+        j.alpha = j.value[0];
+        if (!j.aborted[0] && j.nm > 1) pool_run(p, &j);
+        bool aborted = false;
+        int bi = 0;
+        for (int m = 0; m < j.nm; ++m) {
+            nodes += j.nodes[m];
+            tt_hits += j.tt_hits[m];
+            aborted |= j.aborted[m];
+            if (j.value[m] > j.value[bi]) bi = m;   // empate: la primera en el orden de la raíz
+        }
+        if (aborted) break;
+        best = j.dirs[bi]; done = depth;
+        // la mejor abre la próxima iteración y el resto conserva su orden (la jugada de tabla de ab)
+        for (; bi > 0; --bi) { unsigned char t = j.dirs[bi]; j.dirs[bi] = j.dirs[bi - 1]; j.dirs[bi - 1] = t; }
+        if (j.budget_us > 0 && us_since(&j.t0) * 3u >= j.budget_us) break;
+    }
+
+    // estadísticas en el contexto del llamador (search_last_stats)
+    if (tls_ctx) {
+        tls_ctx->last.depth = done;
+        tls_ctx->last.nodes = nodes;
+        tls_ctx->last.tt_hits = tt_hits;
+        tls_ctx->last.elapsed_us = us_since(&j.t0);
+    }
+    return best;
+}
@@ -1,6 +1,7 @@
 #define _DEFAULT_SOURCE
 #include "shared_mem.h"
 #include "game_utils.h"
+#include "bitboard.h"
 #include <fcntl.h>
 #include <sys/mman.h>
 #include <sys/stat.h>
@@ -10,18 +11,71 @@
 #include <time.h>
 #include <errno.h>
 
-int gs_create_and_init(int W, int H, unsigned nplayers,game_state_t **gs_out, size_t *gs_bytes_out){
-    if (!gs_out || !gs_bytes_out) return -1;
-    if (W <= 0 || H <= 0) return -1;
+#define ALIGN64(n) (((n) + 63u) & ~(size_t)63u)
+
+/* Layout de la zona extendida: [gs_ext_t][free_nbrs W·H][bits (H+6)·stride][cells W·H][dirty].
+   Devuelve los bytes desde el ext; cells solo con GS_F_COMPACT. */
+static size_t ext_layout(int W, int H, unsigned flags, gs_ext_t *out){
+    size_t cells = (size_t)W * (size_t)H;
+    size_t off = sizeof(gs_ext_t);
+    out->nbrs_off = (unsigned)off;
+    off += cells;
+    off = ALIGN64(off);
+    out->bits_off = (unsigned)off;
+    out->bits_stride = (unsigned)(((size_t)W + 2 * GS_BITS_PAD + 63u) / 64u);
+    off += (size_t)(H + 2 * GS_BITS_PAD) * out->bits_stride * sizeof(uint64_t);
+    out->cells_off = 0;
+    if (flags & GS_F_COMPACT) {
+        off = ALIGN64(off);
+        out->cells_off = (unsigned)off;
+        off += cells;
+    }
+    off = ALIGN64(off);
+    out->dirty_off = (unsigned)off;
+    off += GS_DIRTY_CAP * sizeof(uint32_t);
+    return off;
+}
+
+/* Completa encabezado y zona extendida de un estado recién reservado (shm o local) */
+void gs_init_state(game_state_t *gs, size_t bytes, int W, int H, unsigned nplayers, unsigned flags){
+    memset(gs, 0, bytes);
+    gs->width  = (unsigned short)W;
+    gs->height = (unsigned short)H;
+    gs->num_players = nplayers;
+    gs->finished = false;
+
+    gs_ext_t *e = gs_ext(gs);
+    ext_layout(W, H, flags, e);
+    e->magic = GS_EXT_MAGIC;
+    e->free_cells = 0;
+    e->flags = flags & GS_F_COMPACT;
+}
+
+static int gs_check_dims(int W, int H, unsigned nplayers){
+    if (W <= 0 || H <= 0 || W > GS_MAX_SIDE || H > GS_MAX_SIDE) return -1;
     if (nplayers == 0 || nplayers > 9) return -1;
-    if ((size_t)W * (size_t)H > 10000u) return -1;
+    if ((size_t)W * (size_t)H > GS_MAX_CELLS) return -1;
+    return 0;
+}
+
+size_t gs_bytes_for(int W, int H, unsigned flags){
+    gs_ext_t tmp;
+    return gs_ext_offset(W, H) + ext_layout(W, H, flags, &tmp);
+}
+
+int gs_create_and_init(int W, int H, unsigned nplayers, unsigned flags, game_state_t **gs_out, size_t *gs_bytes_out){
+    if (!gs_out || !gs_bytes_out) return -1;
+    if (gs_check_dims(W, H, nplayers) != 0) return -1;
     *gs_out = NULL; *gs_bytes_out = 0;
 
-    size_t bytes = sizeof(game_state_t) + (size_t)W * (size_t)H * sizeof(int);
+    size_t bytes = gs_bytes_for(W, H, flags);
+    /* con huge pages el segmento se redondea a 2 MiB para que quede cubierto entero */
+    if (flags & GS_F_HUGEPAGES) bytes = (bytes + GS_HUGEPAGE - 1) & ~(size_t)(GS_HUGEPAGE - 1);
 
     /* crear shm*/
-    shm_unlink(SHM_STATE);
-    int fd = shm_open(SHM_STATE, O_CREAT|O_EXCL|O_RDWR, 0666);
+    char name[64]; gs_shm_name(name, sizeof name);
+    shm_unlink(name);
+    int fd = shm_open(name, O_CREAT|O_EXCL|O_RDWR, 0666);
     if (fd == -1) return -1;
     if (ftruncate(fd, (off_t)bytes) == -1) { close(fd); return -1; }
 
@@ -29,12 +83,68 @@ int gs_create_and_init(int W, int H, unsigned nplayers,game_state_t **gs_out, si
     close(fd);
     if (gs == MAP_FAILED) return -1;
 
+    /* best-effort: tmpfs solo lo respeta con shmem_enabled=advise/within_size;
+       sin THP en el kernel el segmento sigue funcionando con páginas de 4 KiB */
+    if (flags & GS_F_HUGEPAGES) (void)madvise(gs, bytes, MADV_HUGEPAGE);
+
     /* init */
-    memset(gs, 0, bytes);
-    gs->width  = (unsigned short)W;
-    gs->height = (unsigned short)H;
-    gs->num_players = nplayers;
-    gs->finished = false;
+    gs_init_state(gs, bytes, W, H, nplayers, flags);
+
+    *gs_out = gs;
+    *gs_bytes_out = bytes;
+    return 0;
+}
+
+const char *gs_shm_name(char *buf, size_t n){
+    return shm_ns_name(SHM_STATE, buf, n);
+}
+
+int gs_alloc_local(int W, int H, unsigned nplayers, unsigned flags, game_state_t **gs_out, size_t *gs_bytes_out){
+    if (!gs_out || !gs_bytes_out) return -1;
+    if (gs_check_dims(W, H, nplayers) != 0) return -1;
+    *gs_out = NULL; *gs_bytes_out = 0;
+
+    size_t bytes = gs_bytes_for(W, H, flags);
+    /* alineado a 64: el bitmap se lee por palabras y las filas no deben partir líneas */
+    game_state_t *gs = aligned_alloc(64, ALIGN64(bytes));
+    if (!gs) return -1;
+    gs_init_state(gs, bytes, W, H, nplayers, flags);
+
+    *gs_out = gs;
+    *gs_bytes_out = bytes;
+    return 0;
+}
+
+void gs_free_local(game_state_t *gs){
+    free(gs);
+}
+
+/* Sombra de un /game_state sin zona extendida: encabezado propio en la línea anterior al estado */
+typedef struct {
+    const game_state_t *src;        /* segmento del máster (solo lectura) */
+    size_t src_bytes;
+} gs_shadow_t;
+
+static inline gs_shadow_t *shadow_of(game_state_t *gs){
+    return (gs_shadow_t *)((char *)gs - 64);
+}
+
+static int open_shadow(const game_state_t *src, size_t src_bytes, game_state_t **gs_out, size_t *gs_bytes_out){
+    int W = src->width, H = src->height;
+    if (gs_check_dims(W, H, src->num_players) != 0 ||
+        src_bytes < sizeof(game_state_t) + (size_t)W * (size_t)H * sizeof(int)) {
+        errno = EPROTO;
+        return -1;
+    }
+    size_t bytes = gs_bytes_for(W, H, 0);
+    char *blk = aligned_alloc(64, 64 + ALIGN64(bytes));
+    if (!blk) return -1;
+    game_state_t *gs = (game_state_t *)(blk + 64);
+    gs_init_state(gs, bytes, W, H, src->num_players, 0);
+    gs_ext(gs)->flags |= GS_F_SHADOW;
+    shadow_of(gs)->src = src;
+    shadow_of(gs)->src_bytes = src_bytes;
+    gs_ro_refresh(gs);
 
     *gs_out = gs;
     *gs_bytes_out = bytes;
@@ -46,7 +156,8 @@ int gs_open_ro(game_state_t **gs_out, size_t *gs_bytes_out)
     if (!gs_out || !gs_bytes_out) return -1;
     *gs_out = NULL; *gs_bytes_out = 0;
 
-    int fd = shm_open(SHM_STATE, O_RDONLY, 0);
+    char name[64];
+    int fd = shm_open(gs_shm_name(name, sizeof name), O_RDONLY, 0);
     if (fd == -1) return -1;
 
     struct stat st;
@@ -57,45 +168,147 @@ int gs_open_ro(game_state_t **gs_out, size_t *gs_bytes_out)
     close(fd);
     if (gs == MAP_FAILED) return -1;
 
+    /* sin zona extendida (máster de la cátedra): contadores y bitmap salen de escanear el board */
+    size_t ext_end = gs_ext_offset(gs->width, gs->height) + sizeof(gs_ext_t);
+    if ((size_t)st.st_size < ext_end || gs_ext(gs)->magic != GS_EXT_MAGIC ||
+        (size_t)st.st_size < gs_bytes_for(gs->width, gs->height, gs_ext(gs)->flags)) {
+        if (open_shadow(gs, (size_t)st.st_size, gs_out, gs_bytes_out) == 0) return 0;
+        int e = errno;
+        munmap(gs, (size_t)st.st_size);
+        errno = e;
+        return -1;
+    }
+
     *gs_out = gs;
     *gs_bytes_out = (size_t)st.st_size;
     return 0;
 }
 
+void gs_ro_refresh(game_state_t *gs)
+{
+    gs_ext_t *e = gs_ext(gs);
+    if (!(e->flags & GS_F_SHADOW)) return;
+    const game_state_t *src = shadow_of(gs)->src;
+    memcpy(gs, src, sizeof(game_state_t) + (size_t)gs->width * gs->height * sizeof(int));
+    gs_rebuild_counters(gs);
+    e->dirty_head += GS_DIRTY_CAP + 1u;   /* sin ring de cambios: la vista redibuja todo */
+}
+
 void gs_close(game_state_t *gs, size_t gs_bytes)
 {
-    if (gs && gs_bytes) munmap(gs, gs_bytes);
+    if (!gs || !gs_bytes) return;
+    if (gs_ext(gs)->flags & GS_F_SHADOW) {
+        gs_shadow_t *sh = shadow_of(gs);
+        munmap((void *)sh->src, sh->src_bytes);
+        free(sh);
+        return;
+    }
+    munmap(gs, gs_bytes);
 }
 
 /* ===== utilitarias ligadas al estado ===== */
 
-void gs_init_board_rewards(int *board, int W, int H, unsigned seed)
+static inline uint64_t *ext_bits(gs_ext_t *e){
+    return (uint64_t *)((char *)e + e->bits_off);
+}
+
+static inline void bit_clear(gs_ext_t *e, int x, int y){
+    unsigned bx = (unsigned)(x + GS_BITS_PAD);
+    ext_bits(e)[(size_t)(y + GS_BITS_PAD) * e->bits_stride + (bx >> 6)] &= ~(1ull << (bx & 63u));
+}
+
+/* Anota la celda c en el ring de cambios (la vista redibuja solo esas) */
+static inline void mark_dirty(gs_ext_t *e, int c){
+    uint32_t *ring = (uint32_t *)((char *)e + e->dirty_off);
+    ring[e->dirty_head & (GS_DIRTY_CAP - 1u)] = (uint32_t)c;
+    e->dirty_head++;
+}
+
+/* Marca (x,y) como capturada por owner y mantiene los contadores en O(1) */
+static void capture_cell(game_state_t *gs, int x, int y, int owner){
+    int W = gs->width, H = gs->height;
+    int c = idx_wh(x, y, W);
+    gs_ext_t *e = gs_ext(gs);
+    if (gs->board[c] > 0) {
+        unsigned char *nb = gs_free_nbrs(gs);
+        e->free_cells--;
+        for (int d = 0; d < 8; ++d) {
+            int nx = x + DX[d], ny = y + DY[d];
+            if (in_bounds_wh(nx, ny, W, H)) nb[idx_wh(nx, ny, W)]--;
+        }
+        bit_clear(e, x, y);
+        if (e->cells_off) {
+            unsigned char *cells = (unsigned char *)e + e->cells_off;
+            cells[c] = GS_CELL_PACK(gs->board[c], owner);
+        }
+    } else if (e->cells_off) {
+        unsigned char *cells = (unsigned char *)e + e->cells_off;
+        cells[c] = GS_CELL_PACK(0, owner);
+    }
+    gs->board[c] = -owner;
+    mark_dirty(e, c);
+}
+
+void gs_rebuild_counters(game_state_t *gs){
+    int W = gs->width, H = gs->height;
+    gs_ext_t *e = gs_ext(gs);
+    uint64_t *bits = ext_bits(e);
+    unsigned char *cells = e->cells_off ? (unsigned char *)e + e->cells_off : NULL;
+
+    /* board -> bitmap (y espejo compacto) */
+    memset(bits, 0, (size_t)(H + 2 * GS_BITS_PAD) * e->bits_stride * sizeof(uint64_t));
+    for (int y = 0; y < H; ++y) {
+        uint64_t *row = bits + (size_t)(y + GS_BITS_PAD) * e->bits_stride;
+        for (int x = 0; x < W; ++x) {
+            int v = gs->board[idx_wh(x, y, W)];
+            unsigned bx = (unsigned)(x + GS_BITS_PAD);
+            if (v > 0) row[bx >> 6] |= 1ull << (bx & 63u);
+            if (cells) cells[idx_wh(x, y, W)] = v > 0 ? (unsigned char)v : GS_CELL_PACK(0, -v);
+        }
+    }
+
+    /* bitmap -> contadores, 64 celdas por palabra */
+    gs_cells_t c; gs_cells_bind(&c, gs);
+    bb_mobility_rows(&c, 0, H, gs_free_nbrs(gs));
+    e->free_cells = bb_count_free_rows(&c, 0, H);
+}
+
+/* rng == NULL => rand() global (master); si no, rand_r sobre el estado del caller */
+static inline int rnd_next(unsigned *rng){
+    return rng ? rand_r(rng) : rand();
+}
+
+static void init_board_rewards_with(int *board, int W, int H, unsigned *rng)
 {
     /* valores 1..9 (libres), caller se encarga de marcar capturas negativas */
-    srand(seed ? seed : (unsigned)time(NULL));
     for (int y = 0; y < H; ++y)
         for (int x = 0; x < W; ++x)
-            board[y*W + x] = 1 + (rand() % 9);
+            board[y*W + x] = 1 + (rnd_next(rng) % 9);
 }
 
-int gs_place_players(game_state_t *gs)
+void gs_init_board_rewards(int *board, int W, int H, unsigned seed)
+{
+    srand(seed ? seed : (unsigned)time(NULL));
+    init_board_rewards_with(board, W, H, NULL);
+}
+
+void gs_init_board_rewards_r(int *board, int W, int H, unsigned *rng)
+{
+    init_board_rewards_with(board, W, H, rng);
+}
+
+static int place_players_with(game_state_t *gs, unsigned *rng)
 {
     if (!gs) return -1;
     int W = (int)gs->width, H = (int)gs->height, n = (int)gs->num_players;
     int total = W * H;
-    if (n < 0 || n > 9 || n > total || total > 10000) return -1;
-
-    int positions[10000];
-    for (int i = 0; i < total; ++i) positions[i] = i;
-
-    /* Fisher–Yates */
-    for (int i = total - 1; i > 0; --i) {
-        int j = rand() % (i + 1);
-        int tmp = positions[i]; positions[i] = positions[j]; positions[j] = tmp;
-    }
+    if (n < 0 || n > 9 || n > total) return -1;
+    gs_rebuild_counters(gs); /* board recién sembrado: todo libre */
 
     for (int p = 0; p < n; ++p) {
-        int pos = positions[p];
+        /* muestreo por rechazo: n <= 9 celdas sobre W·H, sin armar ni barajar el tablero */
+        int pos;
+        do { pos = rnd_next(rng) % total; } while (gs->board[pos] <= 0);
         int x = pos % W, y = pos / W;
         gs->players[p].x = (unsigned short)x;
         gs->players[p].y = (unsigned short)y;
@@ -103,18 +316,46 @@ int gs_place_players(game_state_t *gs)
         gs->players[p].valid_moves = 0;
         gs->players[p].invalid_moves = 0;
         gs->players[p].blocked = false;
-        gs->board[y*W + x] = -p; /* capturada por el jugador p */
+        capture_cell(gs, x, y, p); /* capturada por el jugador p */
     }
     return 0;
 }
 
-bool gs_has_valid_move_from(const game_state_t *gs, int x, int y){
-    for (int d=0; d<8; ++d){
-        int nx = x + DX[d], ny = y + DY[d];
-        if (in_bounds_wh(nx,ny, gs->width, gs->height) &&
-            gs->board[idx_wh(nx,ny, gs->width)] > 0) return true;
+int gs_place_players(game_state_t *gs)
+{
+    return place_players_with(gs, NULL);
+}
+
+int gs_place_players_r(game_state_t *gs, unsigned *rng)
+{
+    return place_players_with(gs, rng);
+}
+
+/* ===== reglas de movimiento ===== */
+
+bool gs_apply_move(game_state_t *gs, int i, unsigned char dir){
+    player_t *p = &gs->players[i];
+    // validar dir 0..7
+    if (!dir_is_valid(dir) || p->blocked) { p->invalid_moves++; return false; }
+
+    int W = gs->width, H = gs->height;
+    int nx = (int)p->x + DX[dir], ny = (int)p->y + DY[dir];
+    if (!in_bounds_wh(nx, ny, W, H) || gs->board[idx_wh(nx, ny, W)] <= 0) {
+        p->invalid_moves++;
+        return false;
     }
-    return false;
+    // mover: sumar recompensa, marcar celda, actualizar pos, contadores
+    p->score += (unsigned)gs->board[idx_wh(nx, ny, W)];
+    p->valid_moves++;
+    mark_dirty(gs_ext(gs), idx_wh(p->x, p->y, W));  // la cabeza vieja pasa a ser cuerpo
+    p->x = (unsigned short)nx;
+    p->y = (unsigned short)ny;
+    capture_cell(gs, nx, ny, i);  // capturada por jugador i
+    return true;
+}
+
+bool gs_has_valid_move_from(const game_state_t *gs, int x, int y){
+    return gs_free_nbrs(gs)[idx_wh(x, y, gs->width)] > 0;
 }
 
 bool gs_any_player_can_move(const game_state_t *gs){
@@ -136,8 +377,30 @@ void gs_mark_blocked_players(game_state_t *gs){
 }
 
 unsigned int gs_count_free_cells(const game_state_t *gs){
-    unsigned int tot = (unsigned)gs->width * (unsigned)gs->height, freec = 0;
-    for (unsigned int i=0;i<tot;i++) if (gs->board[i] > 0) freec++;
-    return freec;
+    return gs_ext(gs)->free_cells;
 }
 
+size_t gs_copy_rows(game_state_t *dst, const game_state_t *src, int y0, int y1){
+    int W = src->width, H = src->height;
+    if (y0 < 0) y0 = 0;
+    if (y1 > H) y1 = H;
+
+    /* encabezado + players + zona ext (contadores y offsets) */
+    memcpy(dst, src, sizeof(game_state_t));
+    const gs_ext_t *se = gs_ext(src);
+    gs_ext_t *de = gs_ext(dst);
+    *de = *se;
+    size_t n = sizeof(game_state_t) + sizeof(gs_ext_t);
+    if (y0 >= y1) return n;
+
+    size_t rows = (size_t)(y1 - y0), first = (size_t)y0 * (size_t)W, len = rows * (size_t)W;
+    memcpy(dst->board + first, src->board + first, len * sizeof(int));
+    memcpy((char *)de + se->nbrs_off + first, (const char *)se + se->nbrs_off + first, len);
+    if (se->cells_off)
+        memcpy((char *)de + se->cells_off + first, (const char *)se + se->cells_off + first, len);
+    /* bitmap: las filas de margen son siempre 0 y ya están en dst */
+    size_t words = (size_t)se->bits_stride, wfirst = (size_t)(y0 + GS_BITS_PAD) * words;
+    memcpy((uint64_t *)((char *)de + se->bits_off) + wfirst,
+           (const uint64_t *)((const char *)se + se->bits_off) + wfirst, rows * words * sizeof(uint64_t));
+    return n + len * (sizeof(int) + 1u + (se->cells_off ? 1u : 0u)) + rows * words * sizeof(uint64_t);
+}
@@ -0,0 +1,62 @@
+#define _GNU_SOURCE
+#include "stats_sock.h"
+#include <sys/socket.h>
+#include <unistd.h>
+#include <string.h>
+#include <errno.h>
+
+int ss_open(stats_sock_t *s, const char *path){
+    s->lfd = -1;
+    s->ncli = 0;
+    if (strlen(path) >= sizeof s->path) { errno = ENAMETOOLONG; return -1; }
+    strcpy(s->path, path);
+
+    int fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (fd < 0) return -1;
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof addr);
+    addr.sun_family = AF_UNIX;
+    strcpy(addr.sun_path, path);
+    unlink(path);  // socket de una partida anterior
+    if (bind(fd, (struct sockaddr *)&addr, sizeof addr) != 0 || listen(fd, SS_MAX_CLIENTS) != 0) {
+        int e = errno; close(fd); errno = e;
+        return -1;
+    }
+    s->lfd = fd;
+    return 0;
+}
+
+int ss_accept(stats_sock_t *s){
+    int n = 0;
+    for (;;) {
+        int c = accept4(s->lfd, NULL, NULL, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (c < 0) break;  // EAGAIN: no hay más pendientes
+        if (s->ncli >= SS_MAX_CLIENTS) { close(c); continue; }
+        shutdown(c, SHUT_RD);  // solo lectura para el cliente: el máster nunca lee
+        s->cli[s->ncli++] = c;
+        n++;
+    }
+    return n;
+}
+
+int ss_broadcast(stats_sock_t *s, const char *buf, size_t len){
+    int ok = 0;
+    for (int k = 0; k < s->ncli;) {
+        ssize_t w = send(s->cli[k], buf, len, MSG_DONTWAIT | MSG_NOSIGNAL);
+        if (w == (ssize_t)len) { ok++; k++; continue; }
+        // cerró, error o lento (una línea cortada ya no se puede reanudar): afuera
+        close(s->cli[k]);
+        s->cli[k] = s->cli[--s->ncli];
+    }
+    return ok;
+}
+
+void ss_close(stats_sock_t *s){
+    for (int k = 0; k < s->ncli; ++k) close(s->cli[k]);
+    s->ncli = 0;
+    if (s->lfd >= 0) {
+        close(s->lfd);
+        unlink(s->path);
+    }
+    s->lfd = -1;
+}
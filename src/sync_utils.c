@@ -1,5 +1,6 @@
-#define _DEFAULT_SOURCE
+#define _GNU_SOURCE   // ppoll
 #include "sync_utils.h"
+#include "game_utils.h"   // shm_ns_name
 #include <fcntl.h>
 #include <sys/mman.h>
 #include <sys/stat.h>
@@ -7,13 +8,24 @@
 #include <string.h>
 #include <errno.h>
 #include <time.h>
+#include <poll.h>
+#include <sched.h>
+#include <stdint.h>
+#include <limits.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+
+const char *gx_shm_name(char *buf, size_t n){
+    return shm_ns_name(SHM_SYNC, buf, n);
+}
 
 int gx_create_and_init(game_sync_t **gx_out){
     if (!gx_out) return -1;
     *gx_out = NULL;
 
-    shm_unlink(SHM_SYNC);
-    int fd = shm_open(SHM_SYNC, O_CREAT|O_EXCL|O_RDWR, 0666);
+    char name[64]; gx_shm_name(name, sizeof name);
+    shm_unlink(name);
+    int fd = shm_open(name, O_CREAT|O_EXCL|O_RDWR, 0666);
     if (fd == -1) return -1;
     if (ftruncate(fd, (off_t)sizeof(game_sync_t)) == -1) { close(fd); return -1; }
 
@@ -22,6 +34,14 @@ int gx_create_and_init(game_sync_t **gx_out){
     close(fd);
     if (gx == MAP_FAILED) return -1;
 
+    if (gx_init(gx) != 0) return -1;
+
+    *gx_out = gx;
+    return 0;
+}
+
+int gx_init(game_sync_t *gx){
+    if (!gx) return -1;
     memset(gx, 0, sizeof(*gx));
 
     /* sem_init(pshared=1) */
@@ -34,7 +54,16 @@ int gx_create_and_init(game_sync_t **gx_out){
     for (int i = 0; i < MAXP; ++i)
         if (sem_init(&gx->movement[i], 1, 0) == -1) return -1;
 
-    *gx_out = gx;
+    gx->sync_mode = SYNC_RWLOCK;
+    atomic_init(&gx->state_seq, 0u);
+    gx->transport = XPORT_PIPE;
+    atomic_init(&gx->doorbell, 0u);
+    atomic_init(&gx->master_sleeping, 0u);
+    for (int i = 0; i < MAXP; ++i) {
+        atomic_init(&gx->mbox[i].word, MBOX_IDLE);
+        atomic_init(&gx->mbox[i].sleeping, 0u);
+        atomic_init(&gx->mbox[i].replied_ns, 0ull);
+    }
     return 0;
 }
 
@@ -42,15 +71,30 @@ int gx_open_rw(game_sync_t **gx_out){
     if (!gx_out) return -1;
     *gx_out = NULL;
 
-    int fd = shm_open(SHM_SYNC, O_RDWR, 0);
+    char name[64];
+    int fd = shm_open(gx_shm_name(name, sizeof name), O_RDWR, 0);
     if (fd == -1) return -1;
 
     struct stat st;
     if (fstat(fd, &st) == -1) { close(fd); return -1; }
-    if ((size_t)st.st_size < sizeof(game_sync_t)) { close(fd); return -1; }
+    if ((size_t)st.st_size < offsetof(game_sync_t, sync_mode)) { close(fd); errno = EPROTO; return -1; }
 
-    game_sync_t *gx = mmap(NULL, sizeof(game_sync_t),
-                           PROT_READ|PROT_WRITE, MAP_SHARED, fd, 0);
+    game_sync_t *gx;
+    if ((size_t)st.st_size >= sizeof(game_sync_t)) {
+        gx = mmap(NULL, sizeof(game_sync_t), PROT_READ|PROT_WRITE, MAP_SHARED, fd, 0);
+    } else {
+        /* máster de la cátedra: solo el prefijo está en shm. Se reserva el struct entero en
+           memoria privada y encima se mapea el segmento; las extensiones quedan en 0
+           (SYNC_RWLOCK, XPORT_PIPE, VIEW_SYNC), que es justo el protocolo de la cátedra. */
+        gx = mmap(NULL, sizeof(game_sync_t), PROT_READ|PROT_WRITE, MAP_PRIVATE|MAP_ANONYMOUS, -1, 0);
+        if (gx != MAP_FAILED &&
+            mmap(gx, (size_t)st.st_size, PROT_READ|PROT_WRITE, MAP_SHARED|MAP_FIXED, fd, 0) == MAP_FAILED) {
+            int e = errno;
+            munmap(gx, sizeof(game_sync_t));
+            errno = e;
+            gx = MAP_FAILED;
+        }
+    }
     close(fd);
     if (gx == MAP_FAILED) return -1;
 
@@ -79,17 +123,81 @@ int sem_wait_intr(sem_t *s){
     }
 }
 
+/* Perfil de contención: solo en el build instrumentado; si no, todo se compila a nada */
+#ifdef SYNC_PROF
+static proc_prof_t *g_prof = NULL;                       /* slot del proceso */
+static _Thread_local unsigned long long t_rd_at, t_wr_at; /* inicio de la retención actual */
+
+static void atomic_max_ull(atomic_ullong *m, unsigned long long v){
+    unsigned long long cur = atomic_load_explicit(m, memory_order_relaxed);
+    while (v > cur && !atomic_compare_exchange_weak_explicit(m, &cur, v, memory_order_relaxed, memory_order_relaxed)) {}
+}
+
+static inline unsigned long long prof_now(void){ return g_prof ? sync_now_ns() : 0; }
+
+/* Lock obtenido: suma la espera desde t0 y arranca la retención en *at. Devuelve la espera. */
+static unsigned long long prof_acquired(bool wr, unsigned long long t0, unsigned long long *at){
+    if (!g_prof) return 0;
+    lock_prof_t *l = wr ? &g_prof->wr : &g_prof->rd;
+    unsigned long long now = sync_now_ns(), w = now - t0;
+    atomic_fetch_add_explicit(&l->n, 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&l->wait_ns, w, memory_order_relaxed);
+    atomic_max_ull(&l->wait_max_ns, w);
+    *at = now;
+    return w;
+}
+
+static void prof_released(bool wr, unsigned long long at){
+    if (!g_prof || !at) return;
+    lock_prof_t *l = wr ? &g_prof->wr : &g_prof->rd;
+    unsigned long long h = sync_now_ns() - at;
+    atomic_fetch_add_explicit(&l->hold_ns, h, memory_order_relaxed);
+    atomic_max_ull(&l->hold_max_ns, h);
+}
+
+static inline void prof_retry(void){
+    if (g_prof) atomic_fetch_add_explicit(&g_prof->seq_retries, 1, memory_order_relaxed);
+}
+#define PROF_RD_ACQUIRED(t0)  prof_acquired(false, (t0), &t_rd_at)
+#define PROF_RD_RELEASED()    prof_released(false, t_rd_at)
+#define PROF_WR_ACQUIRED(t0)  do { if (prof_acquired(true, (t0), &t_wr_at) > PROF_STARVE_NS) \
+                                       atomic_fetch_add_explicit(&g_prof->starved, 1, memory_order_relaxed); } while (0)
+#define PROF_WR_RELEASED()    prof_released(true, t_wr_at)
+#define PROF_SEQ_RETRY()      prof_retry()
+#else
+#define prof_now()            0ull
+#define PROF_RD_ACQUIRED(t0)  ((void)(t0))
+#define PROF_RD_RELEASED()    ((void)0)
+#define PROF_WR_ACQUIRED(t0)  ((void)(t0))
+#define PROF_WR_RELEASED()    ((void)0)
+#define PROF_SEQ_RETRY()      ((void)0)
+#endif
+
+void sync_prof_bind(game_sync_t *gx, int slot){
+#ifdef SYNC_PROF
+    if (!gx || slot < 0 || slot >= PROF_SLOTS) return;
+    g_prof = &gx->prof[slot];
+    atomic_store(&g_prof->pid, (int)getpid());
+    if (slot == PROF_SLOT_MASTER) atomic_store(&gx->prof_enabled, 1u);
+#else
+    (void)gx; (void)slot;
+#endif
+}
+
 /* Lectores–Escritor con preferencia al escritor */
 void reader_enter(game_sync_t *gx){
+    unsigned long long t0 = prof_now();
     sem_wait_intr(&gx->writer_starvation_mutex);
     sem_wait_intr(&gx->readers_count_lock);
     gx->readers_count++;
     if (gx->readers_count == 1) sem_wait_intr(&gx->state_write_lock);
     sem_post(&gx->readers_count_lock);
     sem_post(&gx->writer_starvation_mutex);
+    PROF_RD_ACQUIRED(t0);
 }
 
 void reader_exit(game_sync_t *gx){
+    PROF_RD_RELEASED();
     sem_wait_intr(&gx->readers_count_lock);
     if (gx->readers_count > 0) gx->readers_count--;
     if (gx->readers_count == 0) sem_post(&gx->state_write_lock);
@@ -97,18 +205,126 @@ void reader_exit(game_sync_t *gx){
 }
 
 void writer_enter(game_sync_t *gx){
+    unsigned long long t0 = prof_now();
+    if (gx->sync_mode == SYNC_SEQLOCK) {
+        /* único escritor: seq pasa a impar antes de tocar el estado */
+        unsigned s = atomic_load_explicit(&gx->state_seq, memory_order_relaxed);
+        atomic_store_explicit(&gx->state_seq, s + 1, memory_order_relaxed);
+        atomic_thread_fence(memory_order_release);
+        PROF_WR_ACQUIRED(t0);
+        return;
+    }
     sem_wait_intr(&gx->writer_starvation_mutex);
     sem_wait_intr(&gx->state_write_lock);
+    PROF_WR_ACQUIRED(t0);
 }
 
 void writer_exit(game_sync_t *gx){
+    PROF_WR_RELEASED();
+    if (gx->sync_mode == SYNC_SEQLOCK) {
+        unsigned s = atomic_load_explicit(&gx->state_seq, memory_order_relaxed);
+        atomic_store_explicit(&gx->state_seq, s + 1, memory_order_release);
+        return;
+    }
+    /* RWLOCK: la versión se mueve antes de soltar el lock (un lector con el lock la ve estable) */
+    atomic_fetch_add_explicit(&gx->state_seq, 2u, memory_order_release);
     sem_post(&gx->state_write_lock);
     sem_post(&gx->writer_starvation_mutex);
 }
 
-/* Máster ↔ Vista (A/B) + delay */
-void sync_notify_view_and_delay(game_sync_t *gx, bool has_view, int delay_ms, volatile sig_atomic_t *g_stop){
-    if (has_view) {
+unsigned sync_read_begin(game_sync_t *gx){
+    for (unsigned spins = 0;; ++spins) {
+        unsigned s = atomic_load_explicit(&gx->state_seq, memory_order_acquire);
+        if (!(s & 1u)) return s;
+        /* escritura en curso: esperar un poco y ceder la CPU si se alarga */
+        if (spins % 64u == 63u) sched_yield();
+    }
+}
+
+bool sync_read_retry(game_sync_t *gx, unsigned seq){
+    atomic_thread_fence(memory_order_acquire);
+    if (atomic_load_explicit(&gx->state_seq, memory_order_relaxed) == seq) return false;
+    PROF_SEQ_RETRY();
+    return true;
+}
+
+unsigned sync_state_version(game_sync_t *gx){
+    return atomic_load_explicit(&gx->state_seq, memory_order_acquire);
+}
+
+void sync_read_snapshot(game_sync_t *gx, void *dst, const void *src, size_t bytes){
+    if (gx->sync_mode != SYNC_SEQLOCK) {
+        reader_enter(gx);
+        memcpy(dst, src, bytes);
+        reader_exit(gx);
+        return;
+    }
+    unsigned s;
+    do {
+        s = sync_read_begin(gx);
+        memcpy(dst, src, bytes);
+    } while (sync_read_retry(gx, s));
+}
+
+/* Ticks con deadline absoluto */
+void tick_init(tick_sched_t *t, int period_ms, unsigned mode){
+    memset(t, 0, sizeof *t);
+    t->period_ns = period_ms > 0 ? (long long)period_ms * 1000000LL : 0;
+    t->mode = mode;
+    t->wake_fd = -1;
+}
+
+void tick_bind_stop(tick_sched_t *t, volatile sig_atomic_t *stop, int wake_fd){
+    t->stop = stop;
+    t->wake_fd = wake_fd;
+}
+
+void tick_wait(tick_sched_t *t){
+    if (!t || t->period_ns <= 0) return;
+    unsigned long long now = sync_now_ns();
+    if (t->next_ns == 0) t->next_ns = now;   /* primer tick: ancla */
+    t->next_ns += (unsigned long long)t->period_ns;
+    t->ticks++;
+
+    if (now >= t->next_ns) {
+        /* el tick se pasó procesando/dibujando: no dormir y re-anclar */
+        long long late = (long long)(now - t->next_ns);
+        t->overruns++;
+        if (late > t->overrun_max_ns) t->overrun_max_ns = late;
+        t->next_ns = now;
+        return;
+    }
+    if (t->wake_fd < 0) {
+        struct timespec dl = { (time_t)(t->next_ns / 1000000000ull), (long)(t->next_ns % 1000000000ull) };
+        while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &dl, NULL) == EINTR)
+            if (t->stop && *t->stop) return;
+    } else {
+        /* el deadline sigue siendo absoluto: cada vuelta recalcula lo que falta hasta next_ns */
+        for (;;) {
+            if (t->stop && *t->stop) return;
+            unsigned long long left = t->next_ns - now;
+            struct timespec rel = { (time_t)(left / 1000000000ull), (long)(left % 1000000000ull) };
+            struct pollfd pfd = { .fd = t->wake_fd, .events = POLLIN };
+            int r = ppoll(&pfd, 1, &rel, NULL);
+            if (r > 0) return;                  /* señal pendiente: sin stats, el tick no se durmió */
+            if (r < 0 && errno != EINTR) break;
+            now = sync_now_ns();
+            if (now >= t->next_ns) break;
+        }
+    }
+    if (t->stop && *t->stop) return;
+    long long jitter = (long long)(sync_now_ns() - t->next_ns);
+    t->jitter_sum_ns += jitter;
+    if (jitter > t->jitter_max_ns) t->jitter_max_ns = jitter;
+}
+
+/* Máster ↔ Vista (A/B) + tick */
+void sync_notify_view_and_delay(game_sync_t *gx, bool has_view, tick_sched_t *tick, volatile sig_atomic_t *g_stop){
+    if (has_view && gx->view_mode == VIEW_ASYNC) {
+        int pending = 0;
+        if (sem_getvalue(&gx->state_changed, &pending) == 0 && pending == 0)
+            sem_post(&gx->state_changed);  /* A: un aviso alcanza, la vista lee el último estado */
+    } else if (has_view) {
         sem_post(&gx->state_changed);  /* A */
         if (!g_stop || !(*g_stop)) {
             sem_wait_intr(&gx->state_rendered); /* B */
@@ -116,19 +332,142 @@ void sync_notify_view_and_delay(game_sync_t *gx, bool has_view, int delay_ms, vo
             (void)sem_trywait(&gx->state_rendered);
         }
     }
-    if (delay_ms > 0) {
-        struct timespec ts = { delay_ms/1000, (delay_ms%1000) * 1000000L };
-        nanosleep(&ts, NULL);
+    tick_wait(tick);
+}
+
+/* futex compartido entre procesos (sin FUTEX_PRIVATE_FLAG) */
+static int futex_wait(atomic_uint *addr, unsigned expected, const struct timespec *rel){
+    return (int)syscall(SYS_futex, (uint32_t *)addr, FUTEX_WAIT, expected, rel, NULL, 0);
+}
+
+static int futex_wake(atomic_uint *addr, int n){
+    return (int)syscall(SYS_futex, (uint32_t *)addr, FUTEX_WAKE, n, NULL, NULL, 0);
+}
+
+/* Vueltas de espera activa antes de dormir en el futex */
+#define MBOX_SPINS 256
+
+static void mbox_grant(game_sync_t *gx, int i){
+    player_mbox_t *mb = &gx->mbox[i];
+    atomic_store(&mb->word, MBOX_GRANT);
+    if (atomic_load(&mb->sleeping)) futex_wake(&mb->word, 1);
+}
+
+/* 0 = permiso tomado, 1 = venció timeout_ms (< 0: sin límite), -1 = error */
+static int mbox_wait_grant(game_sync_t *gx, int i, int timeout_ms){
+    player_mbox_t *mb = &gx->mbox[i];
+    struct timespec rel = { timeout_ms / 1000, (timeout_ms % 1000) * 1000000L };
+    for (int spins = 0;; ++spins) {
+        unsigned w = atomic_load_explicit(&mb->word, memory_order_acquire);
+        if (w == MBOX_GRANT) break;
+        if (spins < MBOX_SPINS) continue;
+        if (timeout_ms >= 0 && spins > MBOX_SPINS) return 1;   /* ya dormimos una vez */
+
+        atomic_store(&mb->sleeping, 1u);
+        if (atomic_load(&mb->word) == w)           /* re-chequeo tras anunciar que dormimos */
+            if (futex_wait(&mb->word, w, timeout_ms >= 0 ? &rel : NULL) == -1 &&
+                errno != EAGAIN && errno != EINTR && errno != ETIMEDOUT) {
+                atomic_store(&mb->sleeping, 0u);
+                return -1;
+            }
+        atomic_store(&mb->sleeping, 0u);
+    }
+    atomic_store_explicit(&mb->word, MBOX_IDLE, memory_order_relaxed); /* consumir el permiso */
+    return 0;
+}
+
+static void mbox_post(game_sync_t *gx, int i, unsigned word){
+    atomic_store_explicit(&gx->mbox[i].word, word, memory_order_release);
+    atomic_fetch_add(&gx->doorbell, 1u);
+    if (atomic_load(&gx->master_sleeping)) futex_wake(&gx->doorbell, 1);
+}
+
+void mbox_reply(game_sync_t *gx, int i, unsigned char dir){
+    mbox_post(gx, i, MBOX_REPLY | dir);
+}
+
+void mbox_close(game_sync_t *gx, int i){
+    mbox_post(gx, i, MBOX_CLOSED);
+}
+
+unsigned mbox_pending(game_sync_t *gx, int n){
+    unsigned mask = 0;
+    for (int i = 0; i < n && i < MAXP; ++i) {
+        unsigned w = atomic_load_explicit(&gx->mbox[i].word, memory_order_acquire);
+        if (w & (MBOX_REPLY | MBOX_CLOSED)) mask |= 1u << i;
+    }
+    return mask;
+}
+
+int mbox_take(game_sync_t *gx, int i, unsigned char *dir){
+    unsigned w = atomic_load_explicit(&gx->mbox[i].word, memory_order_acquire);
+    if (w & MBOX_CLOSED) {
+        // el cierre se informa una sola vez: si quedara, mbox_pending marcaría al jugador
+        // retirado en cada vuelta y el máster no volvería a dormir en el timbre
+        atomic_store_explicit(&gx->mbox[i].word, MBOX_IDLE, memory_order_relaxed);
+        return 1;
     }
+    if (!(w & MBOX_REPLY)) return 2;
+    *dir = (unsigned char)(w & 0xFFu);
+    atomic_store_explicit(&gx->mbox[i].word, MBOX_IDLE, memory_order_relaxed);
+    return 0;
+}
+
+unsigned mbox_doorbell(game_sync_t *gx){
+    return atomic_load(&gx->doorbell);
+}
+
+void mbox_wait_doorbell(game_sync_t *gx, unsigned seen, int timeout_ms){
+    for (int spins = 0; spins < MBOX_SPINS; ++spins)
+        if (atomic_load_explicit(&gx->doorbell, memory_order_acquire) != seen) return;
+
+    struct timespec rel = { timeout_ms / 1000, (timeout_ms % 1000) * 1000000L };
+    atomic_store(&gx->master_sleeping, 1u);
+    if (atomic_load(&gx->doorbell) == seen)
+        futex_wait(&gx->doorbell, seen, timeout_ms >= 0 ? &rel : NULL);
+    atomic_store(&gx->master_sleeping, 0u);
 }
 
 /* Turnos de jugador */
 int sync_allow_one_move(game_sync_t *gx, int i){
     if (!gx || i < 0 || i >= MAXP) return -1;
+    if (gx->transport == XPORT_FUTEX) { mbox_grant(gx, i); return 0; }
     return sem_post(&gx->movement[i]);
 }
 
 int sync_wait_my_turn(game_sync_t *gx, int i){
+    return sync_wait_my_turn_for(gx, i, -1);
+}
+
+int sync_wait_my_turn_for(game_sync_t *gx, int i, int timeout_ms){
     if (!gx || i < 0 || i >= MAXP) return -1;
-    return sem_wait_intr(&gx->movement[i]);
+    if (gx->transport == XPORT_FUTEX) return mbox_wait_grant(gx, i, timeout_ms);
+    if (timeout_ms < 0) return sem_wait_intr(&gx->movement[i]);
+
+    struct timespec dl;
+    clock_gettime(CLOCK_REALTIME, &dl);
+    dl.tv_sec  += timeout_ms / 1000;
+    dl.tv_nsec += (timeout_ms % 1000) * 1000000L;
+    if (dl.tv_nsec >= 1000000000L) { dl.tv_sec++; dl.tv_nsec -= 1000000000L; }
+    for (;;) {
+        if (sem_timedwait(&gx->movement[i], &dl) == 0) return 0;
+        if (errno == ETIMEDOUT) return 1;
+        if (errno != EINTR) return -1;
+    }
+}
+
+unsigned long long sync_now_ns(void){
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (unsigned long long)ts.tv_sec * 1000000000ull + (unsigned long long)ts.tv_nsec;
+}
+
+void sync_stamp_reply(game_sync_t *gx, int i){
+    if (!gx || i < 0 || i >= MAXP) return;
+    atomic_store_explicit(&gx->mbox[i].replied_ns, sync_now_ns(), memory_order_relaxed);
+}
+
+unsigned long long sync_reply_stamp(game_sync_t *gx, int i){
+    if (!gx || i < 0 || i >= MAXP) return 0;
+    return atomic_load_explicit(&gx->mbox[i].replied_ns, memory_order_relaxed);
 }
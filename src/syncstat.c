@@ -0,0 +1,82 @@
+#define _DEFAULT_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <signal.h>
+#include <errno.h>
+#include <time.h>
+
+#include "sync_utils.h"   // game_sync_t, proc_prof_t, gx_open_rw
+#include "game_utils.h"   // die
+
+/*
+ * Lee en vivo el perfil de contención de /game_sync (build PROF=1) mientras corre una
+ * partida: por proceso, adquisiciones, espera y retención (media/máx) del lock de lector
+ * y de escritor, relecturas del seqlock y esperas de escritor que superan PROF_STARVE_NS.
+ * Los contadores son acumulados desde el inicio de la partida.
+ */
+
+#define USAGE "Uso: syncstat [-i intervalo_ms] [-n muestras (0 = hasta que termine el máster)]"
+
+static void slot_name(int slot, char *out, size_t n){
+    if (slot == PROF_SLOT_MASTER) snprintf(out, n, "master");
+    else if (slot == PROF_SLOT_VIEW) snprintf(out, n, "view");
+    else snprintf(out, n, "player %c", 'A' + (slot - PROF_SLOT_PLAYER(0)));
+}
+
+static void lock_cols(const lock_prof_t *l){
+    unsigned long long n = atomic_load(&l->n);
+    if (n == 0) { printf(" %9s %17s %17s", "-", "-", "-"); return; }
+    printf(" %9llu %8.1f/%-8.1f %8.1f/%-8.1f", n,
+           (double)atomic_load(&l->wait_ns) / 1e3 / (double)n, (double)atomic_load(&l->wait_max_ns) / 1e3,
+           (double)atomic_load(&l->hold_ns) / 1e3 / (double)n, (double)atomic_load(&l->hold_max_ns) / 1e3);
+}
+
+static void dump(game_sync_t *gx, unsigned long sample){
+    printf("\n#%lu  (us: media/máx)\n", sample);
+    printf("%-9s %7s %9s %17s %17s %9s %17s %17s %8s %7s\n", "proceso", "pid",
+           "rd n", "rd espera", "rd retención", "wr n", "wr espera", "wr retención", "seq_rtr", "starved");
+    for (int slot = 0; slot < PROF_SLOTS; ++slot) {
+        const proc_prof_t *p = &gx->prof[slot];
+        int pid = atomic_load(&p->pid);
+        if (pid == 0) continue;
+        char name[16]; slot_name(slot, name, sizeof name);
+        printf("%-9s %7d", name, pid);
+        lock_cols(&p->rd);
+        lock_cols(&p->wr);
+        printf(" %8llu %7llu\n", atomic_load(&p->seq_retries), atomic_load(&p->starved));
+    }
+    fflush(stdout);
+}
+
+int main(int argc, char **argv){
+    int interval_ms = 500;
+    long samples = 0;
+    int opt;
+    while ((opt = getopt(argc, argv, "i:n:")) != -1) {
+        switch (opt) {
+        case 'i': interval_ms = atoi(optarg); break;
+        case 'n': samples = atol(optarg); break;
+        default: die(USAGE);
+        }
+    }
+    if (interval_ms < 1 || samples < 0) die(USAGE);
+
+    game_sync_t *gx = NULL;
+    char name[64];
+    if (gx_open_rw(&gx) != 0) die("gx_open_rw(%s): %s (¿hay una partida corriendo?)", gx_shm_name(name, sizeof name), strerror(errno));
+    if (!atomic_load(&gx->prof_enabled))
+        die("syncstat: el máster no tiene el perfil activo (compilar con make PROF=1)");
+
+    struct timespec ts = { interval_ms / 1000, (interval_ms % 1000) * 1000000L };
+    for (unsigned long k = 1; samples == 0 || (long)k <= samples; ++k) {
+        nanosleep(&ts, NULL);
+        dump(gx, k);
+        // el segmento sigue mapeado aunque el máster lo borre: cortar cuando muere
+        int mpid = atomic_load(&gx->prof[PROF_SLOT_MASTER].pid);
+        if (mpid > 0 && kill(mpid, 0) == -1 && errno == ESRCH) break;
+    }
+    gx_close(gx);
+    return 0;
+}
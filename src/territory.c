@@ -0,0 +1,120 @@
+#include <string.h>
+#include "territory.h"
+#include "bitboard.h"     // bb_row_bits
+
+#define CELLS     (TERR_SIDE * TERR_SIDE)
+#define CONTESTED 0xFFu
+
+/* Espacio de trabajo del hilo: se reserva con el hilo (TLS) y nunca se limpia entero.
+   seen[k] == gen marca la celda k como visitada en la BFS en curso; dist/owner solo
+   valen para celdas marcadas. */
+typedef struct {
+    uint32_t gen;
+    uint32_t seen[CELLS];
+    uint16_t dist[CELLS];
+    uint8_t  owner[CELLS];
+    uint16_t queue[CELLS];            /* cada celda entra a lo sumo una vez */
+} terr_ws_t;
+
+static _Thread_local terr_ws_t tls_ws;
+
+static uint32_t next_gen(terr_ws_t *ws){
+    if (++ws->gen == 0) {             /* vuelta completa: única limpieza, cada 2^32 BFS */
+        memset(ws->seen, 0, sizeof ws->seen);
+        ws->gen = 1;
+    }
+    return ws->gen;
+}
+
+void terr_win_load(terr_win_t *w, const gs_cells_t *b, int cx, int cy){
+    w->b = b;
+    // un eje que entra entero en la ventana se ancla en 0 (exacto); si no, centrada en (cx,cy)
+    w->ox = b->W <= TERR_SIDE ? 0 : cx - TERR_RADIUS;
+    w->oy = b->H <= TERR_SIDE ? 0 : cy - TERR_RADIUS;
+    int xa = w->ox < 0 ? 0 : w->ox;
+    int xb = w->ox + TERR_SIDE > b->W ? b->W : w->ox + TERR_SIDE;
+    w->rows[0] = w->rows[TERR_SIDE + 1] = 0;
+    for (int r = 0; r < TERR_SIDE; ++r) {
+        int y = w->oy + r;
+        w->rows[r + 1] = (y < 0 || y >= b->H || xa >= xb) ? 0u
+                       : bb_row_bits(b, xa, y, (unsigned)(xb - xa)) << (xa - w->ox + 1);
+    }
+}
+
+/* Vecinos libres de la celda (r,c) de la ventana: bits 0-2 fila de arriba, 3 y 5 la propia,
+   6-8 la de abajo (columnas c-1..c+1); NB_OFF[j] es el desplazamiento en índice de celda. */
+static inline unsigned win_nbrs(const terr_win_t *w, int r, int c){
+    return (unsigned)((w->rows[r] >> c) & 7u)
+         | (unsigned)((w->rows[r + 1] >> c) & 5u) << 3
+         | (unsigned)((w->rows[r + 2] >> c) & 7u) << 6;
+}
+
+static const int NB_OFF[9] = {
+    -TERR_SIDE - 1, -TERR_SIDE, -TERR_SIDE + 1,
+    -1,             0,          1,
+    TERR_SIDE - 1,  TERR_SIDE,  TERR_SIDE + 1,
+};
+
+/* BFS por capas desde las fuentes ya encoladas en [0, tail). Una celda alcanzada en la
+   misma capa por dos dueños distintos queda disputada y propaga la disputa. Devuelve tail. */
+static unsigned flood(terr_ws_t *ws, const terr_win_t *w, uint32_t gen, unsigned tail){
+    for (unsigned head = 0; head < tail; ++head) {
+        unsigned k = ws->queue[head];
+        int r = (int)(k / TERR_SIDE), c = (int)(k % TERR_SIDE);
+        uint8_t o = ws->owner[k];
+        uint16_t d = (uint16_t)(ws->dist[k] + 1);
+        for (unsigned m = win_nbrs(w, r, c); m; m &= m - 1) {
+            unsigned nk = (unsigned)((int)k + NB_OFF[__builtin_ctz(m)]);
+            if (ws->seen[nk] != gen) {
+                ws->seen[nk] = gen;
+                ws->dist[nk] = d;
+                ws->owner[nk] = o;
+                ws->queue[tail++] = (uint16_t)nk;
+            } else if (ws->dist[nk] == d && ws->owner[nk] != o) {
+                ws->owner[nk] = CONTESTED;
+            }
+        }
+    }
+    return tail;
+}
+
+// Encola (x,y) como fuente; false si cae fuera de la ventana o ya es fuente
+static bool push_source(terr_ws_t *ws, const terr_win_t *w, uint32_t gen, unsigned *tail, int x, int y, uint8_t owner){
+    int c = x - w->ox, r = y - w->oy;
+    if ((unsigned)c >= TERR_SIDE || (unsigned)r >= TERR_SIDE) return false;
+    unsigned k = (unsigned)(r * TERR_SIDE + c);
+    if (ws->seen[k] == gen) return false;
+    ws->seen[k] = gen;
+    ws->dist[k] = 0;
+    ws->owner[k] = owner;
+    ws->queue[(*tail)++] = (uint16_t)k;
+    return true;
+}
+
+unsigned terr_reachable(const terr_win_t *w, int x, int y){
+    terr_ws_t *ws = &tls_ws;
+    uint32_t gen = next_gen(ws);
+    unsigned tail = 0;
+    if (!push_source(ws, w, gen, &tail, x, y, 0)) return 0;
+    return flood(ws, w, gen, tail) - 1u;
+}
+
+void terr_voronoi(const terr_win_t *w, const int *sx, const int *sy, int n, terr_count_t *out){
+    memset(out, 0, sizeof *out);
+    terr_ws_t *ws = &tls_ws;
+    uint32_t gen = next_gen(ws);
+    unsigned nsrc = 0;
+    for (int i = 0; i < n && i < TERR_NP; ++i)
+        push_source(ws, w, gen, &nsrc, sx[i], sy[i], (uint8_t)i);
+    unsigned tail = flood(ws, w, gen, nsrc);
+
+    // los dueños quedan fijos recién al cerrar cada capa: se cuenta al final
+    for (unsigned q = nsrc; q < tail; ++q) {
+        unsigned k = ws->queue[q];
+        uint8_t o = ws->owner[k];
+        if (o == CONTESTED) { out->contested++; continue; }
+        int x = w->ox + (int)(k % TERR_SIDE), y = w->oy + (int)(k / TERR_SIDE);
+        out->cells[o]++;
+        out->value[o] += (unsigned)gs_cell_value(w->b, x, y);
+    }
+}
@@ -0,0 +1,251 @@
+#define _DEFAULT_SOURCE
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdbool.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+#include <errno.h>
+#include <pthread.h>
+#include <stdatomic.h>
+
+#include "game_utils.h"         // die, dir_is_valid
+#include "shared_mem.h"         // game_state_t, gs_alloc_local, gs_apply_move, gs_mark_blocked_players
+#include "player_strategies.h"  // strategy_t, pick_move_strategy_r
+#include "sync_utils.h"         // MAXP
+#include "search.h"             // search_release
+
+/*
+ * Torneo headless: juega partidas completas en proceso, sin fork/exec, sin shm
+ * y sin semáforos. Cada hilo tiene su propio game_state_t privado y usa las
+ * mismas reglas que el master (gs_apply_move + gs_mark_blocked_players).
+ */
+
+// ============= argv parsing =============
+typedef struct {
+    int w, h;                   // dimensiones del tablero
+    long games;                 // cantidad de partidas
+    int threads;                // hilos de trabajo (default: núcleos online)
+    unsigned int seed;          // semilla base (cada partida deriva la suya)
+    bool endgame;               // cambiar a STRAT_ENDGAME_HARVEST como player.c
+    bool compact;               // estado con espejo compacto (GS_F_COMPACT)
+    unsigned search_ms;         // presupuesto por jugada de "search" (0 = solo profundidad)
+    int search_depth;           // tope de plies de "search" (0 = default)
+    int nplayers;               // jugadores por partida
+    strategy_t strat[MAXP];     // estrategia de cada asiento (antes de rotar)
+} topts_t;
+
+#define USAGE "Uso: tournament [-w W] [-h H] [-n games] [-j threads] [-s seed] [-e] [-c] [-B search_ms] [-D search_depth] -p strat1 [strat2 ...]"
+
+static void parse_opts(int argc, char **argv, topts_t *o);
+
+// ============= resultados =============
+typedef struct {
+    unsigned long games;        // partidas jugadas por la estrategia (por asiento)
+    unsigned long wins;         // victorias sin empate
+    unsigned long long score;   // puntaje acumulado
+} strat_stats_t;
+
+typedef struct {
+    strat_stats_t per[STRAT_COUNT];
+    unsigned long draws;
+    unsigned long long moves;   // movimientos válidos aplicados
+} tally_t;
+
+// ============= workers =============
+typedef struct {
+    const topts_t *o;
+    atomic_long   *next_game;   // cola compartida: próximo índice de partida
+    tally_t        tally;       // acumulado local (se mergea al final)
+} worker_t;
+
+static void *worker_main(void *arg);
+static void play_game(game_state_t *g, const topts_t *o, long k, tally_t *t);
+static int  winner_of(const game_state_t *g);
+
+static double now_s(void){
+    struct timespec ts; clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+// ============= main =============
+int main(int argc, char **argv){
+    topts_t O; parse_opts(argc, argv, &O);
+
+    worker_t *W = calloc((size_t)O.threads, sizeof *W);
+    pthread_t *th = calloc((size_t)O.threads, sizeof *th);
+    if (!W || !th) die("calloc: %s", strerror(errno));
+
+    atomic_long next_game = 0;
+    double t0 = now_s();
+    for (int i = 0; i < O.threads; ++i) {
+        W[i].o = &O;
+        W[i].next_game = &next_game;
+        int rc = pthread_create(&th[i], NULL, worker_main, &W[i]);
+        if (rc != 0) die("pthread_create: %s", strerror(rc));
+    }
+
+    tally_t total; memset(&total, 0, sizeof total);
+    for (int i = 0; i < O.threads; ++i) {
+        pthread_join(th[i], NULL);
+        for (int s = 0; s < STRAT_COUNT; ++s) {
+            total.per[s].games += W[i].tally.per[s].games;
+            total.per[s].wins  += W[i].tally.per[s].wins;
+            total.per[s].score += W[i].tally.per[s].score;
+        }
+        total.draws += W[i].tally.draws;
+        total.moves += W[i].tally.moves;
+    }
+    double secs = now_s() - t0;
+    if (secs <= 0) secs = 1e-9;
+
+    printf("games: %ld  board: %dx%d%s  players: %d  threads: %d  seed: %u\n",
+           O.games, O.w, O.h, O.compact ? " (compact)" : "", O.nplayers, O.threads, O.seed);
+    printf("time: %.3f s  games/s: %.1f  moves/s: %.1f  draws: %lu\n",
+           secs, (double)O.games / secs, (double)total.moves / secs, total.draws);
+    for (int s = 0; s < STRAT_COUNT; ++s) {
+        const strat_stats_t *st = &total.per[s];
+        if (!st->games) continue;
+        printf("  %-9s seats=%-8lu wins=%-8lu win%%=%6.2f  avg_score=%.1f\n",
+               strategy_name((strategy_t)s), st->games, st->wins,
+               100.0 * (double)st->wins / (double)st->games,
+               (double)st->score / (double)st->games);
+    }
+
+    free(W); free(th);
+    return 0;
+}
+
+// ============= funciones auxiliares =============
+static void parse_opts(int argc, char **argv, topts_t *o){
+    o->w = 10; o->h = 10;
+    o->games = 10000;
+    long ncpu = sysconf(_SC_NPROCESSORS_ONLN);
+    o->threads = ncpu > 0 ? (int)ncpu : 1;
+    o->seed = (unsigned)time(NULL);
+    o->endgame = false;
+    o->compact = false;
+    o->search_ms = SEARCH_DEFAULT_BUDGET_MS;
+    o->search_depth = 0;
+    o->nplayers = 0;
+
+    int opt;
+    while ((opt = getopt(argc, argv, "w:h:n:j:s:ecB:D:p:")) != -1) {
+        switch (opt) {
+        case 'w': o->w = atoi(optarg); break;
+        case 'h': o->h = atoi(optarg); break;
+        case 'n': o->games = atol(optarg); break;
+        case 'j': o->threads = atoi(optarg); break;
+        case 's': o->seed = (unsigned)strtoul(optarg, NULL, 10); break;
+        case 'e': o->endgame = true; break;
+        case 'c': o->compact = true; break;
+        case 'B': o->search_ms = (unsigned)strtoul(optarg, NULL, 10); break;
+        case 'D': o->search_depth = atoi(optarg); break;
+        case 'p':
+            // -p strat1 strat2 ... (igual que -p en master); -p puede repetirse
+            if (o->nplayers >= MAXP) die("Demasiados jugadores (max 9)");
+            if (strategy_from_name(optarg, &o->strat[o->nplayers++]) != 0)
+                die("Estrategia desconocida: %s", optarg);
+            while (optind < argc && argv[optind][0] != '-') {
+                if (o->nplayers >= MAXP) die("Demasiados jugadores (max 9)");
+                if (strategy_from_name(argv[optind], &o->strat[o->nplayers++]) != 0)
+                    die("Estrategia desconocida: %s", argv[optind]);
+                optind++;
+            }
+            break;
+        default: die(USAGE);
+        }
+    }
+    if (o->w < 10) o->w = 10;
+    if (o->h < 10) o->h = 10;
+    if (o->games < 1) o->games = 1;
+    if (o->threads < 1) o->threads = 1;
+    if (o->nplayers < 1) die("Error: At least one strategy must be specified using -p.\n" USAGE);
+    if (o->search_ms == 0 && o->search_depth <= 0) die("-B 0 requiere -D (si no, la búsqueda no termina)");
+    strategy_set_search_limits(o->search_ms, o->search_depth);
+}
+
+static void *worker_main(void *arg){
+    worker_t *w = arg;
+    const topts_t *o = w->o;
+
+    game_state_t *g = NULL; size_t bytes = 0;
+    unsigned flags = o->compact ? GS_F_COMPACT : 0;
+    if (gs_alloc_local(o->w, o->h, (unsigned)o->nplayers, flags, &g, &bytes) != 0)
+        die("gs_alloc_local(%dx%d)", o->w, o->h);
+
+    for (;;) {
+        long k = atomic_fetch_add_explicit(w->next_game, 1, memory_order_relaxed);
+        if (k >= o->games) break;
+        play_game(g, o, k, &w->tally);
+    }
+    gs_free_local(g);
+    search_release();
+    return NULL;
+}
+
+// Misma dinámica que master+player: RR sobre jugadores no bloqueados, 1 movimiento por turno.
+static void play_game(game_state_t *g, const topts_t *o, long k, tally_t *t){
+    int n = o->nplayers;
+    unsigned rng = o->seed + (unsigned)k * 2654435761u;   // tablero y desempates: solo de (-s, k)
+
+    // reset del estado (board + jugadores)
+    memset(g->players, 0, sizeof g->players);
+    g->finished = false;
+    gs_init_board_rewards_r(g->board, o->w, o->h, &rng);
+    if (gs_place_players_r(g, &rng) != 0) die("gs_place_players_r");
+
+    // los asientos rotan partida a partida para no favorecer a nadie por posición
+    strategy_t seat[MAXP];
+    bool endgame[MAXP];
+    for (int i = 0; i < n; ++i) {
+        seat[i] = o->strat[(i + k) % n];
+        endgame[i] = false;
+    }
+
+    unsigned int total = (unsigned int)o->w * (unsigned int)o->h;
+    gs_mark_blocked_players(g);
+    while (gs_any_player_can_move(g)) {
+        bool progress = false;
+        for (int i = 0; i < n; ++i) {
+            if (g->players[i].blocked) continue;
+            strategy_t st = seat[i];
+            if (o->endgame && !endgame[i] &&
+                should_switch_to_endgame(gs_count_free_cells(g), total))
+                endgame[i] = true;
+            if (endgame[i]) st = STRAT_ENDGAME_HARVEST;
+
+            unsigned char dir = pick_move_strategy_r(st, g, i, &rng);
+            if (dir == 255) { g->players[i].blocked = true; continue; } // como EOF en el pipe
+            if (gs_apply_move(g, i, dir)) { progress = true; t->moves++; }
+            gs_mark_blocked_players(g);
+        }
+        if (!progress) break; // equivalente al timeout por inactividad
+    }
+    g->finished = true;
+
+    int win = winner_of(g);
+    if (win < 0) t->draws++;
+    for (int i = 0; i < n; ++i) {
+        strat_stats_t *st = &t->per[seat[i]];
+        st->games++;
+        st->score += g->players[i].score;
+        if (i == win) st->wins++;
+    }
+}
+
+// Mayor puntaje; desempata por menos movimientos válidos y luego menos inválidos. -1 si empate.
+static int winner_of(const game_state_t *g){
+    int best = -1; bool tie = false;
+    for (int i = 0; i < (int)g->num_players; ++i) {
+        if (best < 0) { best = i; continue; }
+        const player_t *a = &g->players[i], *b = &g->players[best];
+        int cmp = (a->score != b->score) ? (a->score > b->score ? 1 : -1)
+                : (a->valid_moves != b->valid_moves) ? (a->valid_moves < b->valid_moves ? 1 : -1)
+                : (a->invalid_moves != b->invalid_moves) ? (a->invalid_moves < b->invalid_moves ? 1 : -1)
+                : 0;
+        if (cmp > 0) { best = i; tie = false; }
+        else if (cmp == 0) tie = true;
+    }
+    return tie ? -1 : best;
+}
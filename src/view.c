@@ -6,6 +6,7 @@
 #include <string.h>
 #include <unistd.h>
 #include <errno.h>
+#include <time.h>
 #include <ncurses.h>
 
 #include "shared_mem.h"
@@ -45,7 +46,35 @@ static const short BODY_BG[9];
 static const short HEAD_BG[9];
 
 static void setup_colors(void);
-static void render_board_and_stats(void);
+
+// --- dibujo incremental ---
+// Geometría del último frame: si cambia el tamaño de la terminal o el ring de cambios se
+// desbordó, se redibuja todo; si no, solo las celdas anotadas desde el último frame.
+typedef struct {
+    bool valid;
+    int term_h, term_w;
+    int top, left, box_w, box_h;
+    int grid_y0, grid_x0;
+} layout_t;
+static layout_t L;
+static unsigned g_dirty_seen = 0;   // dirty_head del último frame dibujado
+
+static void frame_pace(struct timespec *next, long period_ns) {
+    next->tv_nsec += period_ns;
+    while (next->tv_nsec >= 1000000000L) { next->tv_sec++; next->tv_nsec -= 1000000000L; }
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    if (now.tv_sec > next->tv_sec || (now.tv_sec == next->tv_sec && now.tv_nsec > next->tv_nsec)) {
+        *next = now;   // el frame tardó más que el período: no recuperar frames perdidos
+        return;
+    }
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, next, NULL) == EINTR) {}
+}
+
+static void draw_cell(const gs_cells_t *cells, int cx, int cy);
+static void render_board_and_stats(const game_state_t *st);
+// VIEW_ASYNC: duerme hasta el próximo frame (deadline absoluto, sin acumular atraso).
+static void frame_pace(struct timespec *next, long period_ns);
 
 //========================= main ========================= 
 int main(int argc, char **argv) {
@@ -64,16 +93,38 @@ int main(int argc, char **argv) {
     size_t GS_BYTES = 0;
     if (gs_open_ro(&gs, &GS_BYTES) != 0) die_ncurses("gs_open_ro: %s", strerror(errno));
     if (gx_open_rw(&gx) != 0) die_ncurses("gx_open_rw: %s", strerror(errno));
+    sync_prof_bind(gx, PROF_SLOT_VIEW);
+
+    // en SEQLOCK o VIEW_ASYNC se dibuja desde una copia privada, sin bloquear al máster
+    bool async = gx->view_mode == VIEW_ASYNC;
+    game_state_t *snap = NULL;
+    if ((gx->sync_mode == SYNC_SEQLOCK || async) && !(snap = malloc(GS_BYTES)))
+        die_ncurses("malloc(snapshot): %s", strerror(errno));
+
+    // VIEW_ASYNC: como mucho un frame cada `period` ns; lo que pase entre medio se junta
+    long period = async ? 1000000000L / (long)(gx->view_fps ? gx->view_fps : 30u) : 0;
+    struct timespec next_frame;
+    clock_gettime(CLOCK_MONOTONIC, &next_frame);
 
     // loop de vista
     for (;;) {
         sem_wait_intr(&gx->state_changed); //master lo despierta por cambios
-        reader_enter(gx);
-        bool finished = gs->finished;
-        render_board_and_stats();  //actualiza tablero
-        reader_exit(gx);
-        if (sem_post(&gx->state_rendered) == -1) die_ncurses("sem_post(state_rendered): %s", strerror(errno));
-        if (finished) break;
+        if (async) while (sem_trywait(&gx->state_changed) == 0) {} // avisos viejos: ya vamos a leer el último
+        bool finished;
+        if (snap) {
+            sync_read_snapshot(gx, snap, gs, GS_BYTES);
+            finished = snap->finished;
+            render_board_and_stats(snap);  //actualiza tablero
+        } else {
+            reader_enter(gx);
+            gs_ro_refresh(gs);   // sombra de un máster sin zona extendida: rearmarla del board
+            finished = gs->finished;
+            render_board_and_stats(gs);  //actualiza tablero
+            reader_exit(gx);
+        }
+        if (!async && sem_post(&gx->state_rendered) == -1) die_ncurses("sem_post(state_rendered): %s", strerror(errno));
+        if (finished) break;  // el último frame siempre se dibuja: finished llega con su propio aviso
+        if (async) frame_pace(&next_frame, period);
     }
 
     // Bloquea en getch() para que el usuario pueda ver el estado final.
@@ -96,6 +147,7 @@ int main(int argc, char **argv) {
     }
 
     endwin();  //finaliza ncurses
+    free(snap);
     gs_close(gs, GS_BYTES);
     gx_close(gx);
 
@@ -175,55 +227,68 @@ static void setup_colors(void) {
     }
 }
 
-static void render_board_and_stats(void) {
+static void draw_cell(const gs_cells_t *cells, int cx, int cy) {
+    int v = gs_cell_value(cells, cx, cy); //valor de la celda
+    int cell_y = L.grid_y0 + cy * CELL_H;
+    int cell_x = L.grid_x0 + cx * CELL_W;
+
+    if (v > 0) { //celda libre
+        draw_rect(cell_y, cell_x, CELL_H, CELL_W, A_NORMAL); //limpia el fondo
+        draw_centered_char(cell_y, cell_x, CELL_H, CELL_W, pair_reward(), (char)('0' + (v % 10))); //imprime valor
+    } else { //celda ocupada
+        int owner = -v;
+        if (owner > 8) owner = 8;
+        draw_rect(cell_y, cell_x, CELL_H, CELL_W, pair_body(owner)); //pinta con color del jugador
+    }
+}
+
+static void render_board_and_stats(const game_state_t *st) {
     // lee informacion de la partida
-    unsigned short W = gs->width, H = gs->height;
-    unsigned int np = gs->num_players; 
+    unsigned short W = st->width, H = st->height;
+    unsigned int np = st->num_players; 
     if (np > 9) np = 9;
+    gs_cells_t cells; gs_cells_bind(&cells, st);  // int o compacto, según el estado
+    const gs_ext_t *e = gs_ext(st);
 
-    // Dimensiones del tablero en caracteres
-    int grid_w = (int)W * CELL_W;
-    int grid_h = (int)H * CELL_H;
-
-    // Tamaño pantalla y centrado
+    // Tamaño pantalla: si cambió (o es el primer frame) se recalcula todo
     int term_h, term_w; 
     getmaxyx(stdscr, term_h, term_w);
-    int box_w = grid_w + 2, box_h = grid_h + 2;
-
-    int top  = (term_h - (box_h + 2 + (int)np)) / 2; if (top  < 0) top  = 0;
-    int left = (term_w -  box_w) / 2;                 if (left < 0) left = 0;
-
-    clear(); 
-    mvprintw(top > 0 ? top - 1 : 0, left, "ChompChamps  %hux%hu", W, H);
-
-    // Marco tablero
-    int y0 = top, x0 = left;
-    draw_box(y0, x0, box_h, box_w);
-
-    // Área interna
-    int grid_y0 = y0 + 1, grid_x0 = x0 + 1;
-
-    // Pintar celdas
-    for (int gy = 0; gy < (int)H; gy++) {
-        for (int gx = 0; gx < (int)W; gx++) {
-            int v = gs->board[idx_wh(gx, gy, gs->width)]; //valor de la celda
-            int cell_y = grid_y0 + gy * CELL_H;
-            int cell_x = grid_x0 + gx * CELL_W;
-
-            if (v > 0) { //celda libre
-                draw_rect(cell_y, cell_x, CELL_H, CELL_W, A_NORMAL); //limpia el fondo
-                draw_centered_char(cell_y, cell_x, CELL_H, CELL_W, pair_reward(), (char)('0' + (v % 10))); //imprime valor
-            } else { //celda ocupada
-                int owner = -v; 
-                if (owner > 8) owner = 8;
-                draw_rect(cell_y, cell_x, CELL_H, CELL_W, pair_body(owner)); //pinta con color del jugador
-            }
+    unsigned pending = e->dirty_head - g_dirty_seen;
+    bool full = !L.valid || term_h != L.term_h || term_w != L.term_w || pending > GS_DIRTY_CAP;
+
+    if (full) {
+        // Dimensiones del tablero en caracteres y centrado
+        int grid_w = (int)W * CELL_W;
+        int grid_h = (int)H * CELL_H;
+        L.term_h = term_h; L.term_w = term_w;
+        L.box_w = grid_w + 2; L.box_h = grid_h + 2;
+        L.top  = (term_h - (L.box_h + 2 + (int)np)) / 2; if (L.top  < 0) L.top  = 0;
+        L.left = (term_w -  L.box_w) / 2;                 if (L.left < 0) L.left = 0;
+        L.grid_y0 = L.top + 1; L.grid_x0 = L.left + 1;   // área interna
+        L.valid = true;
+
+        clear(); 
+        mvprintw(L.top > 0 ? L.top - 1 : 0, L.left, "ChompChamps  %hux%hu", W, H);
+        draw_box(L.top, L.left, L.box_h, L.box_w);   // marco tablero
+
+        // Pintar todas las celdas
+        for (int cy = 0; cy < (int)H; cy++)
+            for (int cx = 0; cx < (int)W; cx++) draw_cell(&cells, cx, cy);
+    } else {
+        // Solo lo que cambió desde el último frame (capturas y cabezas viejas)
+        const uint32_t *ring = gs_dirty_ring(st);
+        for (unsigned k = g_dirty_seen; k != e->dirty_head; ++k) {
+            uint32_t c = ring[k & (GS_DIRTY_CAP - 1u)];
+            draw_cell(&cells, (int)(c % W), (int)(c / W));
         }
     }
+    g_dirty_seen = e->dirty_head;
+    int left = L.left, box_w = L.box_w, y0 = L.top, box_h = L.box_h;
+    int grid_y0 = L.grid_y0, grid_x0 = L.grid_x0;
 
     // Dibuja cabezas + ojos
     for (unsigned int i = 0; i < np; i++) {
-        const player_t *p = &gs->players[i];
+        const player_t *p = &st->players[i];
         char eye = '.';
         if (p->blocked) eye = 'x';   //ojos de jugador bloqueado
 
@@ -251,7 +316,7 @@ static void render_board_and_stats(void) {
     char buf[256];
     int max_linew = 0;
     for (unsigned int i = 0; i < np; i++) {
-        const player_t *p = &gs->players[i];
+        const player_t *p = &st->players[i];
         int len = snprintf(buf, sizeof buf,
                            "%c name=%-10s score=%-4u valid=%-3u invalid=%-3u pos=(%u,%u) %s",
                            'A' + (int)i, p->name, p->score, p->valid_moves, p->invalid_moves,
@@ -273,6 +338,7 @@ static void render_board_and_stats(void) {
     int stats_h = rows + 2;
     int stats_y0 = y0 + box_h + 1;
 
+    move(stats_y0, 0); clrtobot();   // el ancho del cuadro depende de las líneas: sin restos del frame anterior
     draw_box(stats_y0, stats_x0, stats_h, stats_w + 8);
 
     const char *title = "Players";
@@ -282,7 +348,7 @@ static void render_board_and_stats(void) {
     int rstats = stats_y0 + 2;
     int inner_left = stats_x0 + 2;
     for (unsigned int i = 0; i < np; i++) {
-        const player_t *p = &gs->players[i];
+        const player_t *p = &st->players[i];
         attron(COLOR_PAIR(20 + (int)i)); 
         mvprintw(rstats, inner_left, "  "); 
         attroff(COLOR_PAIR(20 + (int)i));